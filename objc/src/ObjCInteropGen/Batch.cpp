@@ -0,0 +1,196 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ClangSession.h"
+#include "Config.h"
+#include "FatalException.h"
+#include "Logging.h"
+#include "SourceScannerConfig.h"
+#include "Stats.h"
+#include "Trace.h"
+
+namespace objcgen {
+
+#ifdef _WIN32
+
+int run_batch(const std::vector<std::string>&, const std::function<int(const std::string&)>&)
+{
+    fatal("Multiple configuration files are not supported on Windows");
+}
+
+#else
+
+struct BatchConfig {
+    const std::string& path_;
+    toml::Value config_;
+    std::vector<SourceUnit> units_;
+};
+
+int start_forked(const std::function<int()>& func)
+{
+    // Otherwise, the buffered output would be printed by both processes
+    std::cout.flush();
+    std::cerr.flush();
+    auto pid = fork();
+    if (pid < 0) {
+        fatal("Cannot create a process: ", std::strerror(errno));
+    }
+    if (pid == 0) {
+        auto status = 1;
+        try {
+            status = func();
+        } catch (const FatalException&) {
+            // FatalException is assumed to print the error message before throwing
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+        std::cout.flush();
+        std::cerr.flush();
+        // Skip the destructors of the objects shared with the parent process
+        _exit(status);
+    }
+    return pid;
+}
+
+int wait_forked(int pid)
+{
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            fatal("Cannot wait for a process: ", std::strerror(errno));
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+/** Run `func` in a forked process and wait for it */
+[[nodiscard]] static int run_forked(const std::function<int()>& func)
+{
+    return wait_forked(start_forked(func));
+}
+
+static void report_failure(const BatchConfig& config)
+{
+    std::cerr << "Generation for `" << config.path_ << "` has failed" << std::endl;
+}
+
+class BatchRunner final {
+public:
+    explicit BatchRunner(const std::function<int(const std::string&)>& generate)
+        : generate_(generate), session_(ClangSession::create())
+    {
+    }
+
+    /**
+     * Parse the sources common to all configurations of the group starting with `parsed`, then
+     * run the configurations having no more sources and the subgroups with different
+     * continuations.
+     */
+    [[nodiscard]] int run(const std::vector<const BatchConfig*>& group, std::size_t parsed);
+
+private:
+    const std::function<int(const std::string&)>& generate_;
+    std::unique_ptr<ClangSession> session_;
+};
+
+int BatchRunner::run(const std::vector<const BatchConfig*>& group, std::size_t parsed)
+{
+    assert(!group.empty());
+    const auto& first_units = group.front()->units_;
+    auto common = first_units.size();
+    for (const auto* config : group) {
+        const auto& units = config->units_;
+        auto mismatch = std::mismatch(units.begin() + static_cast<std::ptrdiff_t>(parsed), units.end(),
+            first_units.begin() + static_cast<std::ptrdiff_t>(parsed), first_units.end());
+        common = std::min(common, static_cast<std::size_t>(mismatch.first - units.begin()));
+    }
+    if (common > parsed) {
+        TraceEvent event("Parsing Objective-C sources");
+        StageTimer timer("Parsing Objective-C sources");
+        event.arg("files", common - parsed).arg("configurations", group.size());
+        try {
+            parse_sources(*session_,
+                std::vector(first_units.begin() + static_cast<std::ptrdiff_t>(parsed),
+                    first_units.begin() + static_cast<std::ptrdiff_t>(common)));
+        } catch (const FatalException&) {
+            for (const auto* config : group) {
+                report_failure(*config);
+            }
+            throw;
+        }
+    }
+
+    // The subgroups are run in the order of their first configurations
+    std::vector<std::vector<const BatchConfig*>> subgroups;
+    auto status = 0;
+    for (const auto* config : group) {
+        if (config->units_.size() == common) {
+            auto config_status = run_forked([this, config] {
+                if (verbosity >= LogLevel::INFO) {
+                    std::cerr << "Generating for `" << config->path_ << '`' << std::endl;
+                }
+                Config::set(config->config_);
+                return generate_(config->path_);
+            });
+            if (config_status != 0) {
+                report_failure(*config);
+                status = 1;
+            }
+            continue;
+        }
+        const auto& next = config->units_[common];
+        auto it = std::find_if(subgroups.begin(), subgroups.end(),
+            [&next, common](const auto& subgroup) { return subgroup.front()->units_[common] == next; });
+        if (it == subgroups.end()) {
+            subgroups.push_back({config});
+        } else {
+            it->push_back(config);
+        }
+    }
+    for (const auto& subgroup : subgroups) {
+        status |= run_forked([this, &subgroup, common] { return run(subgroup, common); });
+    }
+    return status == 0 ? 0 : 1;
+}
+
+int run_batch(const std::vector<std::string>& config_paths, const std::function<int(const std::string&)>& generate)
+{
+    std::vector<BatchConfig> configs;
+    configs.reserve(config_paths.size());
+    {
+        TraceEvent event("Reading configuration");
+        StageTimer timer("Reading configuration");
+        for (const auto& path : config_paths) {
+            auto config = Config::read_toml_file(path);
+            Config::set(config);
+            configs.push_back({path, std::move(config), collect_sources()});
+        }
+    }
+
+    std::vector<const BatchConfig*> group;
+    for (const auto& config : configs) {
+        group.push_back(&config);
+    }
+    return BatchRunner(generate).run(group, 0);
+}
+
+#endif
+
+} // namespace objcgen
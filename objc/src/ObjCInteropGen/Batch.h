@@ -0,0 +1,46 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace objcgen {
+
+/**
+ * Run the generator for several configurations sharing the parsed sources.  The configurations
+ * are grouped by the sequences of (file, Clang arguments) pairs they parse: every common prefix
+ * of the sequences is parsed once, and a forked process continues from the parsed universe for
+ * every different continuation.  `generate` is called in a separate process for every
+ * configuration, with the configuration already current and its sources parsed, and returns the
+ * exit status of that configuration.
+ *
+ * Returns 0 if all configurations have succeeded.  Needs `fork`, so it is not supported on
+ * Windows.
+ */
+[[nodiscard]] int run_batch(
+    const std::vector<std::string>& config_paths, const std::function<int(const std::string&)>& generate);
+
+#ifndef _WIN32
+
+/**
+ * Run `func` in a forked process.  Returns the process ID for `wait_forked`.  The exit status of
+ * the process is the value returned by `func`, or 1 if it has thrown.
+ */
+[[nodiscard]] int start_forked(const std::function<int()>& func);
+
+/** Wait for the process started by `start_forked` and return its exit status */
+[[nodiscard]] int wait_forked(int pid);
+
+#endif
+
+} // namespace objcgen
+
+#endif // BATCH_H
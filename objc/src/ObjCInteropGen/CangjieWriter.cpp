@@ -10,117 +10,22 @@
 #include <iostream>
 #include <set>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
+#include "IndentingStringStream.h"
 #include "Logging.h"
 #include "Mode.h"
 #include "Package.h"
+#include "PackageGraph.h"
 #include "PrintUtils.h"
 #include "Strings.h"
 #include "Symbol.h"
+#include "Trace.h"
 #include "Universe.h"
 
 namespace objcgen {
 
-static constexpr char INDENT[] = "    ";
-static constexpr std::size_t INDENT_LENGTH = sizeof(INDENT) - 1;
-
-static_assert(INDENT_LENGTH == 4);
-
-constexpr char COMMENT[] = "// ";
-constexpr auto COMMENT_LENGTH = sizeof(COMMENT) - 1;
-
-class IndentingStringBuf final : public std::streambuf {
-public:
-    IndentingStringBuf() : buf_(std::ios_base::out)
-    {
-    }
-
-    void indent() noexcept
-    {
-        indentation_ += INDENT;
-    }
-
-    void dedent() noexcept
-    {
-        assert(ends_with(indentation_, INDENT));
-        indentation_.resize(indentation_.size() - INDENT_LENGTH);
-    }
-
-    void set_comment() noexcept
-    {
-        indentation_ += COMMENT;
-    }
-
-    void reset_comment() noexcept
-    {
-        assert(ends_with(indentation_, COMMENT));
-        indentation_.resize(indentation_.size() - COMMENT_LENGTH);
-    }
-
-    std::string str() const
-    {
-        return buf_.str();
-    }
-
-protected:
-    int_type overflow(const int_type ch) override
-    {
-        if (start_line_) {
-            // Print `//` (with proper indentation) even for empty lines
-            auto count = static_cast<std::streamsize>(indentation_.length());
-            if (buf_.sputn(indentation_.data(), count) != count) {
-                return traits_type::eof();
-            }
-        }
-        start_line_ = ch == '\n';
-        return buf_.sputc(traits_type::to_char_type(ch));
-    }
-
-private:
-    std::stringbuf buf_;
-    /**
-     * Indentation spaces printed currently at the beginning of each line.
-     * Includes `//` comments, if any.
-     */
-    std::string indentation_;
-    bool start_line_ = true;
-};
-
-class IndentingStringStream : public std::ostream {
-public:
-    IndentingStringStream() : std::ostream(&fos_buf)
-    {
-    }
-
-    std::string str() const
-    {
-        return fos_buf.str();
-    }
-
-    void indent() noexcept
-    {
-        fos_buf.indent();
-    }
-
-    void dedent() noexcept
-    {
-        fos_buf.dedent();
-    }
-
-    void set_comment() noexcept
-    {
-        fos_buf.set_comment();
-    }
-
-    void reset_comment() noexcept
-    {
-        fos_buf.reset_comment();
-    }
-
-private:
-    IndentingStringBuf fos_buf;
-};
-
 static const Package* current_package;
 static std::set<std::string> imports;
 
@@ -143,6 +48,97 @@ public:
     }
 };
 
+static std::unordered_map<const Package*, SendSignatures> package_send_signatures;
+
+// Print the type as it is passed to objc_msgSend: all object types are `id`, and
+// all pointers are `ptr`, whatever they point to.
+static void print_send_abi_type(std::ostream& output, const Type& type)
+{
+    switch (type.kind()) {
+        case Type::Kind::Unit:
+            output << "Unit";
+            return;
+        case Type::Kind::TypeParam:
+        case Type::Kind::Block:
+            output << "id";
+            return;
+        case Type::Kind::Pointer:
+        case Type::Kind::Function:
+            output << "ptr";
+            return;
+        case Type::Kind::Named: {
+            const auto& type_symbol = type.symbol().as<NamedTypeSymbol>();
+            switch (type_symbol.kind()) {
+                case NamedTypeSymbol::Kind::TypeDef:
+                    print_send_abi_type(output, type_symbol.as<TypeAliasSymbol>().frozen_canonical_type());
+                    return;
+                case NamedTypeSymbol::Kind::Enum:
+                    output << type_symbol.as<EnumDeclarationSymbol>().underlying_type().name();
+                    return;
+                case NamedTypeSymbol::Kind::Interface:
+                case NamedTypeSymbol::Kind::Protocol:
+                    output << "id";
+                    return;
+                default:
+                    break;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    output << Printer(type, PrintFormat::Raw);
+}
+
+/**
+ * Count a message send with the specified parameter and return types in the current package.
+ * The sends with the same C signature could share a single typed `objc_msgSend` cast.
+ */
+static void record_send(const std::vector<const Type*>& parameter_types, const Type& return_type)
+{
+    assert(current_package);
+    std::ostringstream signature;
+    signature << '(';
+    print_list(signature, parameter_types, [](auto& output, const auto* type) { print_send_abi_type(output, *type); });
+    signature << ") -> ";
+    print_send_abi_type(signature, return_type);
+    auto& package_signatures = package_send_signatures[current_package];
+    ++package_signatures.sends_;
+    package_signatures.signatures_.insert(signature.str());
+}
+
+static void record_send(const NonTypeSymbol& method, const Type& return_type)
+{
+    std::vector<const Type*> parameter_types;
+    for (const auto& parameter : method.parameters()) {
+        parameter_types.push_back(&parameter.type());
+    }
+    record_send(parameter_types, return_type);
+}
+
+const SendSignatures* send_signatures(const Package& package)
+{
+    auto it = package_send_signatures.find(&package);
+    return it == package_send_signatures.end() ? nullptr : &it->second;
+}
+
+static void print_send_signatures()
+{
+    for (auto&& package : packages) {
+        const auto* package_signatures = send_signatures(package);
+        if (!package_signatures) {
+            continue;
+        }
+        const auto& [sends, signatures] = *package_signatures;
+        std::cout << "Package `" << package.cangjie_name() << "` sends " << sends << " messages with "
+                  << signatures.size() << " distinct C signatures";
+        if (!signatures.empty()) {
+            std::cout << " (" << sends / signatures.size() << " sends per signature)";
+        }
+        std::cout << std::endl;
+    }
+}
+
 static void collect_import(const FileLevelSymbol& symbol)
 {
     assert(current_package);
@@ -377,92 +373,6 @@ static void write_foreign_name(std::ostream& output, const NonTypeSymbol& method
     }
 }
 
-[[nodiscard]] static bool same_types(const Type& type1, const Type& type2) noexcept
-{
-    const auto* symbol1 = &type1.symbol();
-    const auto* symbol2 = &type2.symbol();
-    const auto* alias = dynamic_cast<const TypeAliasSymbol*>(symbol1);
-    Type t1;
-    if (alias) {
-        t1 = alias->canonical_type();
-        symbol1 = &t1.symbol();
-    } else {
-        t1 = type1;
-    }
-    alias = dynamic_cast<const TypeAliasSymbol*>(symbol2);
-    Type t2;
-    if (alias) {
-        t2 = alias->canonical_type();
-        symbol2 = &t2.symbol();
-    } else {
-        t2 = type2;
-    }
-
-    if (t1.is_cj_direct_option() != t2.is_cj_direct_option()) {
-        return false;
-    }
-
-    switch (t1.kind()) {
-        case Type::Kind::Pointer:
-            if (t2.kind() != Type::Kind::Pointer) {
-                return false;
-            }
-            assert(t1.parameters().size() == 1);
-            assert(t2.parameters().size() == 1);
-            return same_types(*t1.parameters().begin(), *t2.parameters().begin());
-        case Type::Kind::Function: {
-            if (t2.kind() != Type::Kind::Function) {
-                return false;
-            }
-            const auto& parameters1 = t1.parameters();
-            const auto& parameters2 = t2.parameters();
-            return std::equal(parameters1.begin(), parameters1.end(), parameters2.begin(), parameters2.end(),
-                [](const auto& param1, const auto& param2) { return same_types(param1, param2); });
-        }
-        case Type::Kind::VArray:
-            return t2.kind() == Type::Kind::VArray && t1.varray_size() == t2.varray_size() &&
-                same_types(t1.varray_element_type(), t2.varray_element_type());
-        case Type::Kind::TypeParam:
-            return t2.kind() == Type::Kind::TypeParam && &t1.actual_protocol() == &t2.actual_protocol();
-        default:
-            return symbol1 == symbol2;
-    }
-}
-
-[[nodiscard]] static bool is_overloading_constructor(
-    const TypeDeclarationSymbol& type, const NonTypeSymbol& constructor)
-{
-    assert(constructor.is_constructor());
-    auto parameter_count = constructor.parameter_count();
-    for (const auto& member : type.members()) {
-        if (&member == &constructor || !member.is_constructor() || member.parameter_count() != parameter_count) {
-            continue;
-        }
-        auto overloading = true;
-        for (size_t i = 0; i < parameter_count; ++i) {
-            if (!same_types(member.parameter(i).type(), constructor.parameter(i).type())) {
-                overloading = false;
-                break;
-            }
-        }
-        if (overloading) {
-            return true;
-        }
-    }
-    return false;
-}
-
-[[nodiscard]] static NonTypeSymbol* get_method_by_selector(
-    TypeDeclarationSymbol& decl, const std::string& selector, bool is_static)
-{
-    for (auto& member : decl.members()) {
-        if (member.is_member_method() && member.is_static() == is_static && member.selector() == selector) {
-            return &member;
-        }
-    }
-    return nullptr;
-}
-
 static void print_objc_optional(std::ostream& output, const NonTypeSymbol& member)
 {
     if (member.is_objc_optional()) {
@@ -535,7 +445,7 @@ static void print_getter_setter_names(std::ostream& output, const NonTypeSymbol&
                 if (type_alias) {
                     auto& target = type_alias->target();
                     if (target.has_symbol_assigned()) {
-                        auto canonical_type = type_alias->canonical_type();
+                        const auto& canonical_type = type_alias->frozen_canonical_type();
                         if (canonical_type.is_ctype() && canonical_type.contains_pointer_or_func()) {
                             return (*this)(target);
                         }
@@ -628,6 +538,9 @@ static void write_function(IndentingStringStream& output, FuncKind kind, NonType
     output << "func " << escape_keyword(name);
     write_method_parameters(output, function, format);
     write_type(output, return_type, format);
+    if (supported && kind != FuncKind::TopLevelFunc && !generate_definitions_mode()) {
+        record_send(function, return_type);
+    }
     if (generate_definitions_mode() && !is_ctype) {
         if (return_type.is_unit()) {
             output << " { }";
@@ -660,9 +573,16 @@ static void print_objcmirror_attribute(std::ostream& output, const NamedTypeSymb
     output << '\n';
 }
 
+/** Identifies the member among the members of its declaration, the same way for all targets */
+[[nodiscard]] static std::string member_key(const NonTypeSymbol& member)
+{
+    return std::to_string(static_cast<int>(member.kind())) + (member.is_static() ? '+' : '-') + member.selector();
+}
+
 class TypeDeclarationWriter final {
 public:
-    TypeDeclarationWriter(IndentingStringStream& output, TypeDeclarationSymbol& decl) noexcept;
+    TypeDeclarationWriter(
+        IndentingStringStream& output, TypeDeclarationSymbol& decl, CangjieDeclaration& declaration) noexcept;
 
     void write();
 
@@ -674,6 +594,14 @@ private:
     [[nodiscard]] bool is_property_or_ivar_type_supported(
         NonTypeSymbol& member, const Type& type, const std::string& name) const;
 
+    /** Index the methods by selector and the constructors by arity, once for all members */
+    void index_members();
+
+    [[nodiscard]] NonTypeSymbol* get_method_by_selector(const std::string& selector, bool is_static) const;
+
+    /** Whether another constructor has the same parameter types, so they cannot all be `init` */
+    [[nodiscard]] bool is_overloading_constructor(const NonTypeSymbol& constructor) const;
+
     void write_property(const NonTypeSymbol& prop);
     void write_constructor(NonTypeSymbol& constructor);
     void write_instance_variable(NonTypeSymbol& ivar);
@@ -681,16 +609,65 @@ private:
 
     IndentingStringStream& output_;
     TypeDeclarationSymbol& decl_;
+    CangjieDeclaration& declaration_;
     PrintFormat format_;
     bool any_constructor_exists_ = false;
     bool default_constructor_exists_ = false;
+    // The first method with the selector, by instance (0) and static (1) methods
+    std::unordered_map<std::string_view, NonTypeSymbol*> methods_by_selector_[2];
+    std::unordered_map<std::size_t, std::vector<const NonTypeSymbol*>> constructors_by_arity_;
 };
 
-TypeDeclarationWriter::TypeDeclarationWriter(IndentingStringStream& output, TypeDeclarationSymbol& decl) noexcept
-    : output_(output), decl_(decl)
+TypeDeclarationWriter::TypeDeclarationWriter(
+    IndentingStringStream& output, TypeDeclarationSymbol& decl, CangjieDeclaration& declaration) noexcept
+    : output_(output), decl_(decl), declaration_(declaration)
 {
 }
 
+void TypeDeclarationWriter::index_members()
+{
+    for (auto& member : decl_.members()) {
+        if (member.is_member_method()) {
+            methods_by_selector_[member.is_static()].emplace(member.selector(), &member);
+        } else if (member.is_constructor()) {
+            constructors_by_arity_[member.parameter_count()].push_back(&member);
+        }
+    }
+}
+
+NonTypeSymbol* TypeDeclarationWriter::get_method_by_selector(const std::string& selector, bool is_static) const
+{
+    const auto& methods = methods_by_selector_[is_static];
+    const auto it = methods.find(selector);
+    return it == methods.end() ? nullptr : it->second;
+}
+
+bool TypeDeclarationWriter::is_overloading_constructor(const NonTypeSymbol& constructor) const
+{
+    assert(constructor.is_constructor());
+    auto parameter_count = constructor.parameter_count();
+    const auto it = constructors_by_arity_.find(parameter_count);
+    if (it == constructors_by_arity_.end()) {
+        return false;
+    }
+    for (const auto* member : it->second) {
+        if (member == &constructor) {
+            continue;
+        }
+        auto overloading = true;
+        for (size_t i = 0; i < parameter_count; ++i) {
+            if (!same_types(member->parameter(i).type(), constructor.parameter(i).type())) {
+                overloading = false;
+                break;
+            }
+        }
+        if (overloading) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool TypeDeclarationWriter::is_property_or_ivar_type_supported(
     NonTypeSymbol& member, const Type& type, const std::string& name) const
 {
@@ -707,7 +684,7 @@ void TypeDeclarationWriter::write_property(const NonTypeSymbol& prop)
     // 'is_property_or_ivar_type_supported'.  That is because
     // NonTypeSymbol::visit_referenced_types still cannot properly visit all types.
     // Should be fixed later.
-    auto* getter = get_method_by_selector(decl_, getter_name, is_static);
+    auto* getter = get_method_by_selector(getter_name, is_static);
     assert(getter);
     const auto& return_type = getter->return_type();
     assert(!return_type.is_unit());
@@ -738,6 +715,12 @@ void TypeDeclarationWriter::write_property(const NonTypeSymbol& prop)
     }
     output_ << "prop " << escape_keyword(name);
     write_type(output_, return_type, format_);
+    if (supported && !generate_definitions_mode()) {
+        record_send({}, return_type);
+        if (!prop.is_readonly()) {
+            record_send({&return_type}, Type());
+        }
+    }
     if (generate_definitions_mode()) {
         output_ << " {\n";
         output_.indent();
@@ -769,7 +752,10 @@ void TypeDeclarationWriter::write_constructor(NonTypeSymbol& constructor)
     } else {
         output_.set_comment();
     }
-    if (is_overloading_constructor(decl_, constructor)) {
+    if (supported && !generate_definitions_mode()) {
+        record_send(constructor, constructor.return_type());
+    }
+    if (is_overloading_constructor(constructor)) {
         if (!generate_definitions_mode()) {
             output_ << "@ObjCInit ";
         }
@@ -916,6 +902,8 @@ void TypeDeclarationWriter::write()
     }
     output_ << " {\n";
     output_.indent();
+    declaration_.members_begin_ = output_.size();
+    index_members();
     for (auto&& member : decl_.members()) {
         if (member.is_hidden()) {
             continue;
@@ -924,6 +912,7 @@ void TypeDeclarationWriter::write()
         if (closure_depth < UNLIMITED_CLOSURE_DEPTH && member.calculate_reference_level(decl_) > closure_depth) {
             continue;
         }
+        auto begin = output_.size();
         switch (member.kind()) {
             case NonTypeSymbol::Kind::Property:
                 write_property(member);
@@ -944,7 +933,11 @@ void TypeDeclarationWriter::write()
                 write_field(member);
                 break;
         }
+        if (auto end = output_.size(); end != begin) {
+            declaration_.members_.push_back({member_key(member), begin, end});
+        }
     }
+    declaration_.members_end_ = output_.size();
 
     // In the `GENERATE_DEFINITIONS` mode, add a fake default constructor if needed.
     // Otherwise, the following error can happen:
@@ -958,7 +951,8 @@ void TypeDeclarationWriter::write()
     output_ << '}' << std::endl;
 }
 
-static void write_enum_declaration(IndentingStringStream& output, const EnumDeclarationSymbol& enum_decl)
+static void write_enum_declaration(
+    IndentingStringStream& output, const EnumDeclarationSymbol& enum_decl, CangjieDeclaration& declaration)
 {
     // Can be emit_cangjie_strict, does not matter here
     auto enum_decl_printer = emit_cangjie(enum_decl);
@@ -966,60 +960,99 @@ static void write_enum_declaration(IndentingStringStream& output, const EnumDecl
     const auto& underlying_type = enum_decl.underlying_type();
     collect_import(underlying_type);
     output << "public type " << emit_cangjie(enum_decl) << " = " << emit_cangjie(underlying_type) << '\n';
-    enum_decl.for_each_constant([&output, &enum_decl_printer, &underlying_type](const auto& constant) {
+    declaration.members_begin_ = output.size();
+    declaration.flat_ = true;
+    enum_decl.for_each_constant([&](const auto& constant) {
+        auto begin = output.size();
         output << "public const " << escape_keyword(constant.name()) << ": " << enum_decl_printer << " = ";
         print_enum_constant_value(output, underlying_type, constant);
         output << '\n';
+        declaration.members_.push_back({constant.name(), begin, output.size()});
     });
+    declaration.members_end_ = output.size();
+}
+
+/** Render the declarations of the file, collecting its imports */
+[[nodiscard]] static CangjieFile render_file(const PackageFile& package_file)
+{
+    const auto& package = package_file.package();
+    PackageFileScope scope(package);
+    CangjieFile file{package_file.output_path(), package.cangjie_name(), {}, {}, {}};
+    IndentingStringStream output;
+
+    for (auto* symbol : package_file) {
+        auto begin = output.size();
+        CangjieDeclaration declaration{symbol->name(), begin, begin, begin, begin, {}};
+        if (auto* alias = dynamic_cast<TypeAliasSymbol*>(symbol)) {
+            write_type_alias(output, *alias);
+        } else if (auto* type = dynamic_cast<TypeDeclarationSymbol*>(symbol)) {
+            TypeDeclarationWriter(output, *type, declaration).write();
+        } else if (const auto* enum_decl = dynamic_cast<const EnumDeclarationSymbol*>(symbol)) {
+            write_enum_declaration(output, *enum_decl, declaration);
+        } else {
+            auto& top_level = symbol->as<NonTypeSymbol>();
+            assert(top_level.kind() == NonTypeSymbol::Kind::GlobalFunction);
+
+            // Ignore global functions with internal linkage.  Anyway, we cannot use them in
+            // Cangjie.
+            if (top_level.has_internal_linkage()) {
+                continue;
+            }
+
+            write_function(output, FuncKind::TopLevelFunc, top_level, PrintFormat::EmitCangjie);
+        }
+        declaration.end_ = output.size();
+        if (declaration.members_begin_ == begin) {
+            declaration.members_begin_ = declaration.end_;
+            declaration.members_end_ = declaration.end_;
+        }
+        file.declarations_.push_back(std::move(declaration));
+        output << std::endl;
+    }
+
+    file.imports_.assign(imports.begin(), imports.end());
+    file.text_ = output.str();
+    return file;
+}
+
+std::uint64_t write_cangjie_file(const std::filesystem::path& path, const std::string& package,
+    const std::vector<std::string>& import_lines, const std::string& text)
+{
+    create_directories(path.parent_path());
+    std::ofstream file_output(path);
+    file_output << "// Generated by ObjCInteropGen" << std::endl;
+    file_output << std::endl;
+    file_output << "package " << package << std::endl;
+    file_output << std::endl;
+    for (auto&& line : import_lines) {
+        file_output << line << std::endl;
+    }
+    if (!generate_definitions_mode()) {
+        file_output << "import objc.lang.*\n\n";
+    }
+    file_output << text;
+    return static_cast<std::uint64_t>(file_output.tellp());
 }
 
 void write_cangjie()
 {
+    package_send_signatures.clear();
     std::uint64_t generated_files = 0;
     for (auto&& package : packages) {
         for (auto&& package_file : package) {
             assert(&package_file.package() == &package);
 
-            PackageFileScope scope(package);
-
             const auto& file_path = package_file.output_path();
-            create_directories(file_path.parent_path());
-            IndentingStringStream output;
-
-            for (auto* symbol : package_file) {
-                if (auto* alias = dynamic_cast<TypeAliasSymbol*>(symbol)) {
-                    write_type_alias(output, *alias);
-                } else if (auto* type = dynamic_cast<TypeDeclarationSymbol*>(symbol)) {
-                    TypeDeclarationWriter(output, *type).write();
-                } else if (const auto* enum_decl = dynamic_cast<const EnumDeclarationSymbol*>(symbol)) {
-                    write_enum_declaration(output, *enum_decl);
-                } else {
-                    auto& top_level = symbol->as<NonTypeSymbol>();
-                    assert(top_level.kind() == NonTypeSymbol::Kind::GlobalFunction);
-
-                    // Ignore global functions with internal linkage.  Anyway, we cannot use them in
-                    // Cangjie.
-                    if (top_level.has_internal_linkage()) {
-                        continue;
-                    }
-
-                    write_function(output, FuncKind::TopLevelFunc, top_level, PrintFormat::EmitCangjie);
-                }
-                output << std::endl;
+            TraceEvent event("Write " + file_path.filename().u8string(), "write");
+            auto file = render_file(package_file);
+            std::vector<std::string> import_lines;
+            for (const auto& import : file.imports_) {
+                import_lines.push_back("import " + import);
             }
-
-            std::ofstream file_output(file_path);
-            file_output << "// Generated by ObjCInteropGen" << std::endl;
-            file_output << std::endl;
-            file_output << "package " << package.cangjie_name() << std::endl;
-            file_output << std::endl;
-            for (auto&& import : imports) {
-                file_output << "import " << import << std::endl;
-            }
-            if (!generate_definitions_mode()) {
-                file_output << "import objc.lang.*\n\n";
-            }
-            file_output << output.str();
+            package_file.set_size(write_cangjie_file(file_path, file.package_, import_lines, file.text_));
+            event.arg("path", file_path.u8string())
+                .arg("symbols", package_file.symbol_count())
+                .arg("bytes", package_file.size());
 
             generated_files++;
         }
@@ -1031,37 +1064,26 @@ void write_cangjie()
         std::cout << "Generated " << generated_files << " files for " << packages.size() << " packages" << std::endl;
     }
 
+    compute_package_dependencies();
     if (verbosity >= LogLevel::INFO) {
-        for (const auto& input_file : inputs) {
-            for (const auto& symbol : input_file) {
-                if (auto* package_file = symbol.package_file()) {
-                    auto& edge_from = package_file->package();
-                    for (const auto* reference : symbol.references_symbols()) {
-                        if (auto* edge_to = reference->package()) {
-                            if (&edge_from != edge_to) {
-                                edge_from.add_dependency_edge(*edge_to);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        for (auto&& package : packages) {
-            auto& depends_on = package.depends_on();
-            std::cout << "Package `" << package.cangjie_name() << "` depends on " << depends_on.size();
-            if (depends_on.size() == 1) {
-                auto* dependency = *depends_on.begin();
-                std::cout << " package: `" << dependency->cangjie_name() << '`' << std::endl;
-            } else if (depends_on.size() > 1) {
-                std::cout << " packages:" << std::endl;
-                for (auto* dependency : depends_on) {
-                    std::cout << "* " << dependency->cangjie_name() << std::endl;
-                }
-            } else {
-                std::cout << " packages" << std::endl;
-            }
+        print_package_dependencies();
+        print_send_signatures();
+    }
+}
+
+std::vector<CangjieFile> render_cangjie()
+{
+    package_send_signatures.clear();
+    std::vector<CangjieFile> files;
+    for (auto&& package : packages) {
+        for (auto&& package_file : package) {
+            TraceEvent event("Render " + package_file.output_path().filename().u8string(), "write");
+            files.push_back(render_file(package_file));
+            event.arg("symbols", package_file.symbol_count());
         }
     }
+    compute_package_dependencies();
+    return files;
 }
 
 } // namespace objcgen
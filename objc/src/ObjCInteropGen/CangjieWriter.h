@@ -8,10 +8,72 @@
 #ifndef CANGJIEWRITER_H
 #define CANGJIEWRITER_H
 
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace objcgen {
 
+class Package;
+
+/** A member of a type declaration, or a constant of an enum, in `CangjieFile::text_` */
+struct CangjieMember {
+    /** Identifies the member among the members of its declaration */
+    std::string key_;
+    std::size_t begin_;
+    std::size_t end_;
+};
+
+/** A declaration of a symbol in `CangjieFile::text_` */
+struct CangjieDeclaration {
+    /** Identifies the declaration among the declarations of its file */
+    std::string key_;
+    std::size_t begin_;
+    std::size_t end_;
+    /** The range of the members, which follow each other with nothing in between */
+    std::size_t members_begin_;
+    std::size_t members_end_;
+    std::vector<CangjieMember> members_;
+    /** Whether the members are top-level declarations themselves, like the enum constants */
+    bool flat_ = false;
+};
+
+/** A Cangjie file with the ranges of its declarations, each followed by an empty line */
+struct CangjieFile {
+    std::filesystem::path path_;
+    std::string package_;
+    /** The imported declarations, without `objc.lang.*` */
+    std::vector<std::string> imports_;
+    std::string text_;
+    std::vector<CangjieDeclaration> declarations_;
+};
+
+/** The message sends written for a package, for the report of their distinct C signatures */
+struct SendSignatures {
+    std::size_t sends_ = 0;
+    std::unordered_set<std::string> signatures_;
+};
+
 void write_cangjie();
 
+/**
+ * The message sends of the package written by the last `write_cangjie` or `render_cangjie`,
+ * or nullptr if the package sends no messages
+ */
+[[nodiscard]] const SendSignatures* send_signatures(const Package& package);
+
+/** Render the files of all packages without writing them */
+[[nodiscard]] std::vector<CangjieFile> render_cangjie();
+
+/**
+ * Write a file of the package with the declarations in `text`.  `import_lines` are written as
+ * is, each followed by a new line.  Returns the size of the file.
+ */
+std::uint64_t write_cangjie_file(const std::filesystem::path& path, const std::string& package,
+    const std::vector<std::string>& import_lines, const std::string& text);
+
 } // namespace objcgen
 
 #endif // CANGJIEWRITER_H
@@ -14,13 +14,25 @@
 
 namespace objcgen {
 
+struct SourceUnit;
+
 class ClangSession {
 public:
     [[nodiscard]] static std::unique_ptr<ClangSession> create();
 
     virtual ~ClangSession() = default;
 
-    virtual void parse_sources(const std::vector<std::string>& files, const std::vector<std::string>& arguments) = 0;
+    /**
+     * Parse the source files of `units` with their Clang arguments, adding the declarations to
+     * the universe in the order of the units.  Every translation unit is disposed right after
+     * that.  With `skip_function_bodies_`, the bodies of the functions and methods (like the
+     * `static inline` helpers of the SDK headers) are not parsed, which does not change the
+     * declarations the generator sees.
+     */
+    virtual void parse_sources(const std::vector<SourceUnit>& units) = 0;
+
+    /** The files read while parsing the sources so far, including the source files themselves */
+    [[nodiscard]] virtual std::vector<std::string> included_files() const = 0;
 
 protected:
     explicit ClangSession() = default;
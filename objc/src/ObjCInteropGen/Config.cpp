@@ -155,7 +155,17 @@ toml::Value TomlFileParser::parse(const std::string& path)
 
 void Config::parse_from_toml_file(const std::string& path)
 {
-    g_config = TomlFileParser().parse(path);
+    set(read_toml_file(path));
+}
+
+toml::Value Config::read_toml_file(const std::string& path)
+{
+    return TomlFileParser().parse(path);
+}
+
+void Config::set(toml::Value config)
+{
+    g_config = std::move(config);
     assert(g_config.is<toml::Table>());
     const auto* closure_depth_value = g_config.find("closure-depth");
     if (closure_depth_value) {
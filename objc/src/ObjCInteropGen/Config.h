@@ -20,6 +20,12 @@ class Config {
 public:
     static void parse_from_toml_file(const std::string& path);
 
+    /** Read the TOML file with its imports merged, without making it the current configuration */
+    [[nodiscard]] static toml::Value read_toml_file(const std::string& path);
+
+    /** Make the configuration returned by `read_toml_file` the current one */
+    static void set(toml::Value config);
+
     static const toml::Value* find(const std::string& key);
 
     static ClosureDepthType closure_depth() noexcept;
@@ -0,0 +1,610 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Daemon.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <optional>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ClangSession.h"
+#include "Config.h"
+#include "FatalException.h"
+#include "Logging.h"
+#include "SourceScannerConfig.h"
+#include "Strings.h"
+
+namespace objcgen {
+
+#ifdef _WIN32
+
+int serve(const std::string&, const std::function<int(const std::vector<std::string>&)>&)
+{
+    fatal("--serve is not supported on Windows");
+}
+
+int connect_to_server(const std::string&, const std::vector<std::string>&)
+{
+    fatal("--connect is not supported on Windows");
+}
+
+#else
+
+/** The most resident processes kept by the server; the least recently used one is stopped first */
+constexpr std::size_t MAX_RESIDENTS = 4;
+
+[[nodiscard]] static bool write_all(int fd, const void* data, std::size_t size) noexcept
+{
+    const auto* bytes = static_cast<const char*>(data);
+    while (size != 0) {
+        auto written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/** Returns false if the end of the stream or an error is reached before `size` bytes are read */
+[[nodiscard]] static bool read_all(int fd, void* data, std::size_t size) noexcept
+{
+    auto* bytes = static_cast<char*>(data);
+    while (size != 0) {
+        auto received = read(fd, bytes, size);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+// A message is a list of strings, sent as the payload size followed by the payload, which is the
+// strings each terminated by a null character.
+
+using Message = std::vector<std::string>;
+
+[[nodiscard]] static std::string encode(const Message& message)
+{
+    std::string payload;
+    for (const auto& item : message) {
+        payload += item;
+        payload += '\0';
+    }
+    return payload;
+}
+
+[[nodiscard]] static bool write_message(int fd, const Message& message)
+{
+    auto payload = encode(message);
+    auto size = static_cast<std::uint32_t>(payload.size());
+    return write_all(fd, &size, sizeof(size)) && write_all(fd, payload.data(), payload.size());
+}
+
+[[nodiscard]] static std::optional<Message> read_payload(int fd, std::uint32_t size)
+{
+    std::string payload(size, '\0');
+    if (!read_all(fd, payload.data(), payload.size())) {
+        return std::nullopt;
+    }
+    Message message;
+    std::size_t start = 0;
+    for (auto end = payload.find('\0'); end != std::string::npos; end = payload.find('\0', start)) {
+        message.emplace_back(payload, start, end - start);
+        start = end + 1;
+    }
+    return message;
+}
+
+/** Returns `std::nullopt` if the peer has closed the connection */
+[[nodiscard]] static std::optional<Message> read_message(int fd)
+{
+    std::uint32_t size;
+    if (!read_all(fd, &size, sizeof(size))) {
+        return std::nullopt;
+    }
+    return read_payload(fd, size);
+}
+
+/** Send the client connection and its request to a resident process */
+[[nodiscard]] static bool send_request(int control, int client, const Message& request)
+{
+    auto payload = encode(request);
+    auto size = static_cast<std::uint32_t>(payload.size());
+    iovec data{&size, sizeof(size)};
+    alignas(cmsghdr) char buffer[CMSG_SPACE(sizeof(int))] = {};
+    msghdr header{};
+    header.msg_iov = &data;
+    header.msg_iovlen = 1;
+    header.msg_control = buffer;
+    header.msg_controllen = sizeof(buffer);
+    auto* control_message = CMSG_FIRSTHDR(&header);
+    control_message->cmsg_level = SOL_SOCKET;
+    control_message->cmsg_type = SCM_RIGHTS;
+    control_message->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(control_message), &client, sizeof(int));
+    ssize_t sent;
+    do {
+        sent = sendmsg(control, &header, 0);
+    } while (sent < 0 && errno == EINTR);
+    return sent == static_cast<ssize_t>(sizeof(size)) && write_all(control, payload.data(), payload.size());
+}
+
+/** Returns `std::nullopt` if the server has closed the control connection */
+[[nodiscard]] static std::optional<std::pair<int, Message>> receive_request(int control)
+{
+    std::uint32_t size;
+    iovec data{&size, sizeof(size)};
+    alignas(cmsghdr) char buffer[CMSG_SPACE(sizeof(int))] = {};
+    msghdr header{};
+    header.msg_iov = &data;
+    header.msg_iovlen = 1;
+    header.msg_control = buffer;
+    header.msg_controllen = sizeof(buffer);
+    ssize_t received;
+    do {
+        received = recvmsg(control, &header, 0);
+    } while (received < 0 && errno == EINTR);
+    auto* control_message = CMSG_FIRSTHDR(&header);
+    if (received <= 0 || !control_message || control_message->cmsg_type != SCM_RIGHTS) {
+        return std::nullopt;
+    }
+    int client;
+    std::memcpy(&client, CMSG_DATA(control_message), sizeof(int));
+    auto* rest = reinterpret_cast<char*>(&size) + received;
+    auto request = read_all(control, rest, sizeof(size) - static_cast<std::size_t>(received))
+        ? read_payload(control, size)
+        : std::nullopt;
+    if (!request) {
+        close(client);
+        return std::nullopt;
+    }
+    return std::pair(client, std::move(*request));
+}
+
+/** Sends the exit status of the request, which is the last byte of the response */
+static void send_status(int client, int status) noexcept
+{
+    auto byte = static_cast<std::uint8_t>(status);
+    (void)write_all(client, &byte, 1);
+}
+
+/** Redirects the standard output and error to the client connection for its lifetime */
+class OutputRedirection final {
+public:
+    explicit OutputRedirection(int client) : output_(dup(STDOUT_FILENO)), error_(dup(STDERR_FILENO))
+    {
+        std::cout.flush();
+        std::cerr.flush();
+        dup2(client, STDOUT_FILENO);
+        dup2(client, STDERR_FILENO);
+    }
+
+    OutputRedirection(const OutputRedirection&) = delete;
+
+    OutputRedirection& operator=(const OutputRedirection&) = delete;
+
+    ~OutputRedirection()
+    {
+        std::cout.flush();
+        std::cerr.flush();
+        dup2(output_, STDOUT_FILENO);
+        dup2(error_, STDERR_FILENO);
+        close(output_);
+        close(error_);
+    }
+
+private:
+    int output_;
+    int error_;
+};
+
+/** Wait for the process, returning its exit status, or 1 if it has been killed */
+static int wait_for(pid_t pid) noexcept
+{
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+/**
+ * A process keeping the sources parsed.  `files_` are the files read by the parsing, with their
+ * modification times at the time of parsing.
+ */
+struct Resident {
+    std::string key_;
+    pid_t pid_;
+    int control_;
+    std::vector<std::pair<std::string, std::filesystem::file_time_type>> files_;
+    std::uint64_t last_used_;
+
+    [[nodiscard]] bool up_to_date() const
+    {
+        return std::all_of(files_.begin(), files_.end(), [](const auto& file) {
+            std::error_code error;
+            return std::filesystem::last_write_time(file.first, error) == file.second && !error;
+        });
+    }
+};
+
+class Server final {
+public:
+    Server(int listener, const std::function<int(const std::vector<std::string>&)>& generate)
+        : listener_(listener), generate_(generate)
+    {
+    }
+
+    /** Handle a client connection.  The connection is closed by the caller. */
+    void handle(int client);
+
+private:
+    /**
+     * Run the request in a process forked from the resident one and send the exit status to the
+     * client.  Called by the resident process.
+     */
+    void run_request(int control, int client, const Message& request) const;
+
+    /** The main loop of the resident process, which never returns */
+    [[noreturn]] void run_resident(
+        int control, int client, const Message& request, const std::vector<SourceUnit>& units) const;
+
+    void start_resident(std::string key, const std::vector<SourceUnit>& units, int client, const Message& request);
+
+    void stop_resident(std::vector<Resident>::iterator it);
+
+    const int listener_;
+    const std::function<int(const std::vector<std::string>&)>& generate_;
+    std::vector<Resident> residents_;
+    std::uint64_t clock_ = 0;
+};
+
+void Server::run_request(int control, int client, const Message& request) const
+{
+    std::cout.flush();
+    std::cerr.flush();
+    auto pid = fork();
+    if (pid == 0) {
+        close(control);
+        dup2(client, STDOUT_FILENO);
+        dup2(client, STDERR_FILENO);
+        close(client);
+        auto status = generate_(std::vector(request.begin() + 1, request.end()));
+        std::cout.flush();
+        std::cerr.flush();
+        _exit(status);
+    }
+    send_status(client, pid < 0 ? 1 : wait_for(pid));
+    close(client);
+}
+
+void Server::run_resident(int control, int client, const Message& request, const std::vector<SourceUnit>& units) const
+{
+    auto session = ClangSession::create();
+    auto parsed = false;
+    {
+        OutputRedirection redirection(client);
+        try {
+            parse_sources(*session, units);
+            parsed = true;
+        } catch (const FatalException&) {
+            // FatalException is assumed to print the error message before throwing
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    if (!parsed) {
+        send_status(client, 1);
+        (void)write_message(control, {"failed"});
+        _exit(1);
+    }
+
+    Message report{"parsed"};
+    for (const auto& file : session->included_files()) {
+        report.push_back(std::filesystem::absolute(file).u8string());
+    }
+    if (!write_message(control, report)) {
+        _exit(1);
+    }
+    run_request(control, client, request);
+    while (auto next = receive_request(control)) {
+        run_request(control, next->first, next->second);
+    }
+    _exit(0);
+}
+
+void Server::start_resident(
+    std::string key, const std::vector<SourceUnit>& units, int client, const Message& request)
+{
+    if (residents_.size() >= MAX_RESIDENTS) {
+        stop_resident(std::min_element(residents_.begin(), residents_.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.last_used_ < rhs.last_used_; }));
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        fatal("Cannot create a socket pair: ", std::strerror(errno));
+    }
+    // A file changed after the parsing has started is considered changed on the next request
+    auto parse_start = std::filesystem::file_time_type::clock::now();
+    std::cout.flush();
+    std::cerr.flush();
+    auto pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        fatal("Cannot create a process: ", std::strerror(errno));
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        close(listener_);
+        for (const auto& resident : residents_) {
+            close(resident.control_);
+        }
+        run_resident(fds[1], client, request, units);
+    }
+    close(fds[1]);
+
+    auto report = read_message(fds[0]);
+    if (!report || report->empty() || report->front() != "parsed") {
+        close(fds[0]);
+        wait_for(pid);
+        return;
+    }
+    Resident resident{std::move(key), pid, fds[0], {}, ++clock_};
+    for (auto it = report->begin() + 1; it != report->end(); ++it) {
+        std::error_code error;
+        auto time = std::filesystem::last_write_time(*it, error);
+        resident.files_.emplace_back(*it, error || time >= parse_start ? parse_start : time);
+    }
+    residents_.push_back(std::move(resident));
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Started resident process " << pid << " with " << report->size() - 1 << " files" << std::endl;
+    }
+}
+
+void Server::stop_resident(std::vector<Resident>::iterator it)
+{
+    // The resident process exits after finishing its current request when the control
+    // connection is closed
+    close(it->control_);
+    wait_for(it->pid_);
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Stopped resident process " << it->pid_ << std::endl;
+    }
+    residents_.erase(it);
+}
+
+/**
+ * The key identifying the parsed state needed by the request, which is the working directory
+ * (the paths in the configuration can be relative) and the sources to parse.
+ */
+[[nodiscard]] static std::string source_key(const std::string& directory, const std::vector<SourceUnit>& units)
+{
+    return directory + sources_key(units);
+}
+
+void Server::handle(int client)
+{
+    auto request = read_message(client);
+    if (!request || request->empty()) {
+        return;
+    }
+
+    std::vector<SourceUnit> units;
+    std::string key;
+    {
+        // The errors in the request are reported to the client
+        OutputRedirection redirection(client);
+        try {
+            const auto& directory = request->front();
+            std::filesystem::current_path(directory);
+            std::vector<std::string> config_paths;
+            std::copy_if(request->begin() + 1, request->end(), std::back_inserter(config_paths),
+                [](const auto& arg) { return ends_with(arg, ".toml"); });
+            if (config_paths.size() != 1) {
+                fatal("A request should have a single configuration file");
+            }
+            Config::parse_from_toml_file(config_paths.front());
+            units = collect_sources();
+            key = source_key(directory, units);
+        } catch (const FatalException&) {
+            // FatalException is assumed to print the error message before throwing
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    if (key.empty()) {
+        send_status(client, 1);
+        return;
+    }
+
+    auto it = std::find_if(
+        residents_.begin(), residents_.end(), [&key](const auto& resident) { return resident.key_ == key; });
+    if (it != residents_.end()) {
+        if (it->up_to_date() && send_request(it->control_, client, *request)) {
+            it->last_used_ = ++clock_;
+            return;
+        }
+        stop_resident(it);
+    }
+    start_resident(std::move(key), units, client, *request);
+}
+
+/** Whether a server accepts connections on the socket at `address` */
+[[nodiscard]] static bool is_server_listening(const sockaddr_un& address) noexcept
+{
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    auto connected = connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    close(fd);
+    return connected;
+}
+
+/**
+ * Whether the client runs as the same user as the server.  The requests change the directory
+ * and write files as the server user, so no other user may send them.
+ */
+[[nodiscard]] static bool is_same_user(int client) noexcept
+{
+#ifdef __APPLE__
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(client, &uid, &gid) != 0) {
+        return false;
+    }
+#else
+    ucred credentials{};
+    socklen_t size = sizeof(credentials);
+    if (getsockopt(client, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) {
+        return false;
+    }
+    auto uid = credentials.uid;
+#endif
+    return uid == geteuid();
+}
+
+int serve(const std::string& socket_path, const std::function<int(const std::vector<std::string>&)>& generate)
+{
+    // Writing to a disconnected client should fail instead of killing the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        fatal("Socket path `", socket_path, "` is too long");
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fatal("Cannot create a socket: ", std::strerror(errno));
+    }
+    std::error_code error;
+    if (std::filesystem::is_socket(socket_path, error)) {
+        if (is_server_listening(address)) {
+            fatal("Another server is listening on socket `", socket_path, '`');
+        }
+        // The socket left by a killed server
+        std::filesystem::remove(socket_path, error);
+    }
+    // Only the owner may connect to the socket
+    auto old_mask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    auto bound = bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    auto bind_error = errno;
+    umask(old_mask);
+    if (!bound) {
+        fatal("Cannot bind socket `", socket_path, "`: ", std::strerror(bind_error));
+    }
+    if (chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) != 0) {
+        fatal("Cannot restrict the permissions of socket `", socket_path, "`: ", std::strerror(errno));
+    }
+    if (listen(listener, SOMAXCONN) != 0) {
+        fatal("Cannot listen on socket `", socket_path, "`: ", std::strerror(errno));
+    }
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Listening on `" << socket_path << '`' << std::endl;
+    }
+
+    Server server(listener, generate);
+    for (;;) {
+        auto client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            fatal("Cannot accept a connection: ", std::strerror(errno));
+        }
+        if (is_same_user(client)) {
+            server.handle(client);
+        } else {
+            std::cerr << "Rejected a connection from another user" << std::endl;
+            send_status(client, 1);
+        }
+        close(client);
+    }
+}
+
+int connect_to_server(const std::string& socket_path, const std::vector<std::string>& args)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        fatal("Socket path `", socket_path, "` is too long");
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        fatal("Cannot create a socket: ", std::strerror(errno));
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        fatal("Cannot connect to `", socket_path, "`: ", std::strerror(errno));
+    }
+
+    Message request{std::filesystem::current_path().u8string()};
+    request.insert(request.end(), args.begin(), args.end());
+    if (!write_message(fd, request)) {
+        fatal("Cannot send the request to `", socket_path, "`: ", std::strerror(errno));
+    }
+
+    // The last byte of the response is the exit status, so it is held back
+    std::optional<char> last;
+    char buffer[4096];
+    for (;;) {
+        auto received = read(fd, buffer, sizeof(buffer));
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        if (last) {
+            std::cout.put(*last);
+        }
+        std::cout.write(buffer, received - 1);
+        last = buffer[received - 1];
+    }
+    close(fd);
+    std::cout.flush();
+    if (!last) {
+        std::cerr << "The server has closed the connection without a response" << std::endl;
+        return 1;
+    }
+    return static_cast<std::uint8_t>(*last);
+}
+
+#endif
+
+} // namespace objcgen
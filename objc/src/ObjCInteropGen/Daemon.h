@@ -0,0 +1,41 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace objcgen {
+
+/**
+ * Serve the generator requests sent by `connect_to_server` on the Unix socket.  A request is a
+ * command line with a single configuration file.
+ *
+ * The parsed sources are kept by a resident process per distinct set of sources, which is
+ * created on the first request for the set and parses the sources once.  Every request is run
+ * by `generate` in a process forked from the resident one, so the requests start from the same
+ * parsed universe and cannot affect each other.  The resident process is replaced when any file
+ * read by the parsing changes.  The output of the request and its exit status are sent back to
+ * the client.
+ *
+ * Runs until killed.  Not supported on Windows.
+ */
+[[nodiscard]] int serve(
+    const std::string& socket_path, const std::function<int(const std::vector<std::string>&)>& generate);
+
+/**
+ * Send the command line to the server listening on the Unix socket, copy the output of the
+ * request to the standard output and return its exit status.
+ */
+[[nodiscard]] int connect_to_server(const std::string& socket_path, const std::vector<std::string>& args);
+
+} // namespace objcgen
+
+#endif // DAEMON_H
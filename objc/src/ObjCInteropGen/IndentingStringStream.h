@@ -0,0 +1,134 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef INDENTINGSTRINGSTREAM_H
+#define INDENTINGSTRINGSTREAM_H
+
+#include <cassert>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "Strings.h"
+
+namespace objcgen {
+
+static constexpr char INDENT[] = "    ";
+static constexpr std::size_t INDENT_LENGTH = sizeof(INDENT) - 1;
+
+static_assert(INDENT_LENGTH == 4);
+
+constexpr char COMMENT[] = "// ";
+constexpr auto COMMENT_LENGTH = sizeof(COMMENT) - 1;
+
+class IndentingStringBuf final : public std::streambuf {
+public:
+    IndentingStringBuf() : buf_(std::ios_base::out)
+    {
+    }
+
+    void indent() noexcept
+    {
+        indentation_ += INDENT;
+    }
+
+    void dedent() noexcept
+    {
+        assert(ends_with(indentation_, INDENT));
+        indentation_.resize(indentation_.size() - INDENT_LENGTH);
+    }
+
+    void set_comment() noexcept
+    {
+        indentation_ += COMMENT;
+    }
+
+    void reset_comment() noexcept
+    {
+        assert(ends_with(indentation_, COMMENT));
+        indentation_.resize(indentation_.size() - COMMENT_LENGTH);
+    }
+
+    std::string str() const
+    {
+        return buf_.str();
+    }
+
+    /** The number of characters written so far */
+    [[nodiscard]] std::size_t size()
+    {
+        return static_cast<std::size_t>(buf_.pubseekoff(0, std::ios_base::cur, std::ios_base::out));
+    }
+
+protected:
+    int_type overflow(const int_type ch) override
+    {
+        if (start_line_) {
+            // Print `//` (with proper indentation) even for empty lines
+            auto count = static_cast<std::streamsize>(indentation_.length());
+            if (buf_.sputn(indentation_.data(), count) != count) {
+                return traits_type::eof();
+            }
+        }
+        start_line_ = ch == '\n';
+        return buf_.sputc(traits_type::to_char_type(ch));
+    }
+
+private:
+    std::stringbuf buf_;
+    /**
+     * Indentation spaces printed currently at the beginning of each line.
+     * Includes `//` comments, if any.
+     */
+    std::string indentation_;
+    bool start_line_ = true;
+};
+
+class IndentingStringStream : public std::ostream {
+public:
+    IndentingStringStream() : std::ostream(&fos_buf)
+    {
+    }
+
+    std::string str() const
+    {
+        return fos_buf.str();
+    }
+
+    /** The number of characters written so far, which is the position of the next one in `str()` */
+    [[nodiscard]] std::size_t size()
+    {
+        return fos_buf.size();
+    }
+
+    void indent() noexcept
+    {
+        fos_buf.indent();
+    }
+
+    void dedent() noexcept
+    {
+        fos_buf.dedent();
+    }
+
+    void set_comment() noexcept
+    {
+        fos_buf.set_comment();
+    }
+
+    void reset_comment() noexcept
+    {
+        fos_buf.reset_comment();
+    }
+
+private:
+    IndentingStringBuf fos_buf;
+};
+
+} // namespace objcgen
+
+#endif // INDENTINGSTRINGSTREAM_H
@@ -0,0 +1,202 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <cassert>
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace objcgen {
+
+/**
+ * Minimal streaming JSON writer used for the machine-readable reports (manifests, traces, statistics).
+ * Values are written as soon as they are added, so the caller is responsible for the proper nesting.
+ */
+class JsonWriter final {
+public:
+    explicit JsonWriter(std::ostream& output) : output_(output)
+    {
+    }
+
+    JsonWriter(const JsonWriter&) = delete;
+
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    ~JsonWriter()
+    {
+        assert(scopes_.empty());
+    }
+
+    JsonWriter& begin_object()
+    {
+        return open('{');
+    }
+
+    JsonWriter& end_object()
+    {
+        return close('}');
+    }
+
+    JsonWriter& begin_array()
+    {
+        return open('[');
+    }
+
+    JsonWriter& end_array()
+    {
+        return close(']');
+    }
+
+    JsonWriter& key(std::string_view name)
+    {
+        assert(!scopes_.empty() && scopes_.back().is_object_);
+        separate();
+        write_string(name);
+        output_ << ": ";
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& string(std::string_view value)
+    {
+        separate();
+        write_string(value);
+        return *this;
+    }
+
+    template <class T> JsonWriter& number(T value)
+    {
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+        separate();
+        if constexpr (std::is_floating_point_v<T>) {
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(value));
+            output_ << buffer;
+        } else if constexpr (std::is_signed_v<T>) {
+            output_ << static_cast<long long>(value);
+        } else {
+            output_ << static_cast<unsigned long long>(value);
+        }
+        return *this;
+    }
+
+    JsonWriter& boolean(bool value)
+    {
+        separate();
+        output_ << (value ? "true" : "false");
+        return *this;
+    }
+
+    JsonWriter& null()
+    {
+        separate();
+        output_ << "null";
+        return *this;
+    }
+
+private:
+    struct Scope {
+        bool is_object_;
+        bool empty_;
+    };
+
+    JsonWriter& open(char bracket)
+    {
+        separate();
+        output_ << bracket;
+        scopes_.push_back({bracket == '{', true});
+        return *this;
+    }
+
+    JsonWriter& close(char bracket)
+    {
+        assert(!scopes_.empty() && scopes_.back().is_object_ == (bracket == '}'));
+        assert(!after_key_);
+        auto empty = scopes_.back().empty_;
+        scopes_.pop_back();
+        if (!empty) {
+            new_line();
+        }
+        output_ << bracket;
+        if (scopes_.empty()) {
+            output_ << '\n';
+        }
+        return *this;
+    }
+
+    /** Print a delimiter and indentation before the next value or key */
+    void separate()
+    {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (scopes_.empty()) {
+            return;
+        }
+        auto& scope = scopes_.back();
+        if (!scope.empty_) {
+            output_ << ',';
+        }
+        scope.empty_ = false;
+        new_line();
+    }
+
+    void new_line()
+    {
+        output_ << '\n';
+        for (std::size_t i = 0; i < scopes_.size(); ++i) {
+            output_ << "  ";
+        }
+    }
+
+    void write_string(std::string_view value)
+    {
+        output_ << '"';
+        for (auto ch : value) {
+            switch (ch) {
+                case '"':
+                    output_ << "\\\"";
+                    break;
+                case '\\':
+                    output_ << "\\\\";
+                    break;
+                case '\n':
+                    output_ << "\\n";
+                    break;
+                case '\r':
+                    output_ << "\\r";
+                    break;
+                case '\t':
+                    output_ << "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20) {
+                        char escaped[7];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+                        output_ << escaped;
+                    } else {
+                        output_ << ch;
+                    }
+            }
+        }
+        output_ << '"';
+    }
+
+    std::ostream& output_;
+    std::vector<Scope> scopes_;
+    bool after_key_ = false;
+};
+
+} // namespace objcgen
+
+#endif // JSONWRITER_H
@@ -0,0 +1,95 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "MappedFile.h"
+
+#include <cassert>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace objcgen {
+
+// Both systems keep the view valid after the file and the mapping handles are closed, so only
+// the view is kept.  An empty file cannot be mapped and is represented by the empty view.
+
+#ifdef _WIN32
+
+bool MappedFile::map(const std::filesystem::path& path)
+{
+    assert(!data_);
+    auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    auto result = GetFileSizeEx(file, &size);
+    if (result && size.QuadPart > 0) {
+        auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (view) {
+            data_ = static_cast<const char*>(view);
+            size_ = static_cast<std::size_t>(size.QuadPart);
+        } else {
+            result = FALSE;
+        }
+    }
+    CloseHandle(file);
+    return result;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+}
+
+#else
+
+bool MappedFile::map(const std::filesystem::path& path)
+{
+    assert(!data_);
+    auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    auto result = fstat(file, &status) == 0;
+    if (result && status.st_size > 0) {
+        auto size = static_cast<std::size_t>(status.st_size);
+        auto* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (view != MAP_FAILED) {
+            data_ = static_cast<const char*>(view);
+            size_ = size;
+        } else {
+            result = false;
+        }
+    }
+    close(file);
+    return result;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+#endif
+
+} // namespace objcgen
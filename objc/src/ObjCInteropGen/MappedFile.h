@@ -0,0 +1,47 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace objcgen {
+
+/**
+ * A whole file mapped read-only into memory (mmap on POSIX, MapViewOfFile on Windows).
+ * The data stays valid till the destruction even if the file is replaced by renaming another
+ * one over it.
+ */
+class MappedFile final {
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    /** Returns false if the file cannot be opened or mapped */
+    [[nodiscard]] bool map(const std::filesystem::path& path);
+
+    [[nodiscard]] std::string_view data() const noexcept
+    {
+        return {data_, size_};
+    }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace objcgen
+
+#endif // MAPPEDFILE_H
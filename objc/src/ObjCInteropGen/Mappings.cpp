@@ -9,19 +9,143 @@
 #include <iostream>
 
 #include "FatalException.h"
+#include "Logging.h"
 #include "Universe.h"
 
 namespace objcgen {
 
-std::deque<TypeMapping> mappings;
+TypeMappings mappings;
 
 NamedTypeSymbol& TypeMapping::map() const
 {
-    auto* result = Universe::get().type(to_);
-    if (!result) {
-        fatal("Unknown type ", to_, " specified in [[mappings]]");
+    if (!to_type_) {
+        to_type_ = Universe::get().type(to_);
+        if (!to_type_) {
+            fatal("Unknown type ", to_, " specified in [[mappings]]");
+        }
     }
-    return *result;
+    return *to_type_;
+}
+
+/** The regular expression of the `from` pattern, or nothing if `from` is a type name */
+[[nodiscard]] static std::optional<std::string> pattern_regex(const std::string& from)
+{
+    if (from.size() > 2 && from.front() == '/' && from.back() == '/') {
+        return from.substr(1, from.size() - 2);
+    }
+    if (from.find_first_of("*?") == std::string::npos) {
+        return std::nullopt;
+    }
+    std::string regex;
+    for (auto c : from) {
+        switch (c) {
+            case '*':
+                regex += ".*";
+                break;
+            case '?':
+                regex += '.';
+                break;
+            case '.':
+            case '^':
+            case '$':
+            case '|':
+            case '(':
+            case ')':
+            case '[':
+            case ']':
+            case '{':
+            case '}':
+            case '+':
+            case '\\':
+                regex += '\\';
+                regex += c;
+                break;
+            default:
+                regex += c;
+                break;
+        }
+    }
+    return regex;
+}
+
+/**
+ * Whether `regex` contains a backreference like `\1`.  The patterns are combined into a single
+ * expression, where the group numbers differ from those in the separate patterns.
+ */
+[[nodiscard]] static bool has_backreference(const std::string& regex)
+{
+    for (std::size_t i = 0; i + 1 < regex.size(); ++i) {
+        if (regex[i] == '\\') {
+            auto next = regex[++i];
+            if (next >= '1' && next <= '9') {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TypeMappings::add(std::string from, std::string to)
+{
+    auto regex = pattern_regex(from);
+    const auto& mapping = mappings_.emplace_back(std::move(from), std::move(to));
+    if (!regex) {
+        by_name_.insert_or_assign(mapping.from(), &mapping);
+        return;
+    }
+    try {
+        std::regex check(*regex);
+    } catch (const std::regex_error& e) {
+        fatal("`mappings` pattern `", mapping.from(), "` has thrown an error: ", describe_regex_error(e.code()));
+    }
+    if (has_backreference(*regex)) {
+        fatal("`mappings` pattern `", mapping.from(), "` contains a backreference, which is not supported");
+    }
+    patterns_.emplace_back(&mapping, std::move(*regex));
+    combined_patterns_.reset();
+}
+
+void TypeMappings::compile_patterns() const
+{
+    // The later patterns go first to take precedence, as the first matching alternative wins
+    std::string combined;
+    pattern_groups_.assign(patterns_.size(), 0);
+    std::size_t group = 1;
+    for (auto i = patterns_.size(); i-- > 0;) {
+        const auto& regex = patterns_[i].second;
+        if (!combined.empty()) {
+            combined += '|';
+        }
+        combined += '(';
+        combined += regex;
+        combined += ')';
+        pattern_groups_[i] = group;
+        group += 1 + std::regex(regex).mark_count();
+    }
+    combined_patterns_.emplace(combined);
+}
+
+const TypeMapping* TypeMappings::find(const std::string& type_name) const
+{
+    if (const auto it = by_name_.find(type_name); it != by_name_.end()) {
+        return it->second;
+    }
+    if (patterns_.empty()) {
+        return nullptr;
+    }
+    if (!combined_patterns_) {
+        compile_patterns();
+    }
+    std::smatch match;
+    if (!std::regex_match(type_name, match, *combined_patterns_)) {
+        return nullptr;
+    }
+    for (auto i = patterns_.size(); i-- > 0;) {
+        if (match[pattern_groups_[i]].matched) {
+            return patterns_[i].first;
+        }
+    }
+    return nullptr;
 }
 
 void initialize_mappings()
@@ -32,7 +156,7 @@ void initialize_mappings()
 
 void add_non_generic_mapping(std::string from, std::string to)
 {
-    mappings.emplace_back(std::move(from), std::move(to));
+    mappings.add(std::move(from), std::move(to));
 }
 
 } // namespace objcgen
@@ -8,8 +8,12 @@
 #ifndef MAPPINGS_H
 #define MAPPINGS_H
 
+#include <deque>
+#include <optional>
+#include <regex>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 #include "Symbol.h"
 
@@ -21,19 +25,56 @@ public:
     {
     }
 
-    [[nodiscard]] bool can_map(const NamedTypeSymbol& type) const noexcept
+    /** The mapped type name, or the pattern of the mapped type names */
+    [[nodiscard]] const std::string& from() const noexcept
     {
-        return from_ == type.name();
+        return from_;
     }
 
+    [[nodiscard]] const std::string& to() const noexcept
+    {
+        return to_;
+    }
+
+    /** The type to map to, looked up once */
     [[nodiscard]] NamedTypeSymbol& map() const;
 
 private:
     const std::string from_;
     const std::string to_;
+    mutable NamedTypeSymbol* to_type_ = nullptr;
+};
+
+/**
+ * The `[[mappings]]` entries indexed by the mapped type names.  The names are looked up in a
+ * hash map.  The patterns (globs like `NS*Ref` and regular expressions like `/CG.+Ref/`) are
+ * compiled into a single regular expression, which is tried only for the names not mapped
+ * exactly.  If several entries map a type, the last one is applied.
+ */
+class TypeMappings final {
+public:
+    void add(std::string from, std::string to);
+
+    [[nodiscard]] const TypeMapping* find(const std::string& type_name) const;
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mappings_.size();
+    }
+
+private:
+    void compile_patterns() const;
+
+    std::deque<TypeMapping> mappings_;
+    std::unordered_map<std::string, const TypeMapping*> by_name_;
+    /** The pattern entries with their regular expressions, in the order of addition */
+    std::vector<std::pair<const TypeMapping*, std::string>> patterns_;
+    mutable std::optional<std::regex> combined_patterns_;
+    /** The index of the group matching the whole alternative in `combined_patterns_`, per pattern */
+    mutable std::vector<std::size_t> pattern_groups_;
 };
 
-extern std::deque<TypeMapping> mappings;
+extern TypeMappings mappings;
 
 void initialize_mappings();
 
@@ -6,51 +6,98 @@
 
 #include "MarkPackage.h"
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
+#include <unordered_map>
 
+#include "FatalException.h"
 #include "InputFile.h"
 #include "Logging.h"
 #include "Package.h"
+#include "PackageGraph.h"
+#include "Trace.h"
 #include "Universe.h"
+#include "UsedSymbols.h"
 
 namespace objcgen {
 
+/**
+ * Names of the entities used by the Cangjie code, if the usage-driven pruning is configured.  In
+ * that case, only the used entities matching the package filters are roots.  The rest of the
+ * entities matching the filters are candidates: they are output to their packages only if they
+ * are reachable from the roots within `closure-depth`.
+ */
+static std::optional<std::unordered_set<std::string>> used_symbols;
+static std::unordered_map<const FileLevelSymbol*, Package*> candidates;
+static std::vector<FileLevelSymbol*> promoted_candidates;
+
+[[nodiscard]] static bool is_used(const FileLevelSymbol& symbol)
+{
+    if (!used_symbols || used_symbols->count(symbol.name()) != 0) {
+        return true;
+    }
+    // Enumerations are used if any of their constants is used
+    bool used = false;
+    if (const auto* enum_decl = dynamic_cast<const EnumDeclarationSymbol*>(&symbol)) {
+        enum_decl->for_each_constant([&used](const EnumConstantSymbol& constant) {
+            if (!used && used_symbols->count(constant.name()) != 0) {
+                used = true;
+            }
+        });
+    }
+    return used;
+}
+
 [[nodiscard]] static bool set_package(FileLevelSymbol& symbol)
 {
     bool success = true;
 
     const auto& name = symbol.name();
 
-    bool package_found = false;
+    Package* symbol_package = nullptr;
 
     for (auto&& package : packages) {
         if (!package.filters()->apply(name)) {
             continue;
         }
 
-        if (symbol.package()) {
-            std::cerr << "Entity `" << name << "` is ambiguous between packages `" << symbol.package()->cangjie_name()
+        if (symbol_package) {
+            std::cerr << "Entity `" << name << "` is ambiguous between packages `" << symbol_package->cangjie_name()
                       << "` and `" << package.cangjie_name() << '`' << std::endl;
             success = false;
             continue;
         }
 
-        assert(symbol.output_status() == OutputStatus::Undefined);
-        symbol.set_output_status(OutputStatus::Root);
-        symbol.register_for_package(package);
-        package_found = true;
+        symbol_package = &package;
     }
 
-    if (!package_found && verbosity >= LogLevel::TRACE) {
-        std::cerr << "Entity `" << name << "` does not match any package filter" << std::endl;
+    if (!symbol_package) {
+        if (verbosity >= LogLevel::TRACE) {
+            std::cerr << "Entity `" << name << "` does not match any package filter" << std::endl;
+        }
+    } else if (is_used(symbol)) {
+        assert(symbol.output_status() == OutputStatus::Undefined);
+        symbol.set_output_status(OutputStatus::Root);
+        symbol.register_for_package(*symbol_package);
+    } else {
+        candidates.emplace(&symbol, symbol_package);
+        if (verbosity >= LogLevel::TRACE) {
+            std::cerr << "Entity `" << name << "` matches package `" << symbol_package->cangjie_name()
+                      << "` but is not used" << std::endl;
+        }
     }
     return success;
 }
 
 [[nodiscard]] static bool mark_roots()
 {
+    TraceEvent event("mark_roots", "mark_package");
     auto success = true;
 
+    used_symbols = read_used_symbols();
+    candidates.clear();
+
     auto& universe = Universe::get();
     for (auto& member : universe.top_level()) {
         if (!set_package(member)) {
@@ -70,9 +117,105 @@ namespace objcgen {
         }
     }
 
+    if (used_symbols) {
+        event.arg("used_names", used_symbols->size()).arg("candidates", candidates.size());
+    }
     return success;
 }
 
+/**
+ * The package for the entities referenced from several packages that have no single closest
+ * common dependency, if `fallback-package` is configured.
+ */
+static Package* fallback_package;
+static std::uint64_t placed_in_common_packages;
+/** The packages reachable from the key package by the dependency edges, including itself */
+static std::unordered_map<const Package*, std::unordered_set<const Package*>> reachable_packages;
+
+[[nodiscard]] static Package* read_fallback_package()
+{
+    const auto* name_any = Config::find("fallback-package");
+    if (!name_any) {
+        return nullptr;
+    }
+    if (!name_any->is<std::string>()) {
+        fatal("`fallback-package` should be a TOML string");
+    }
+    const auto& name = name_any->as<std::string>();
+    auto* package = packages.by_cangjie_name(name);
+    if (!package) {
+        fatal("`fallback-package` `", name, "` is not one of the `packages`");
+    }
+    return package;
+}
+
+[[nodiscard]] static const std::unordered_set<const Package*>& reachable_from(const Package& package)
+{
+    auto [it, inserted] = reachable_packages.try_emplace(&package);
+    auto& reachable = it->second;
+    if (inserted) {
+        std::vector<const Package*> stack{&package};
+        reachable.insert(&package);
+        while (!stack.empty()) {
+            const auto* current = stack.back();
+            stack.pop_back();
+            for (const auto* dependency : current->depends_on()) {
+                if (reachable.insert(dependency).second) {
+                    stack.push_back(dependency);
+                }
+            }
+        }
+    }
+    return reachable;
+}
+
+/**
+ * Select the package for the entity referenced from several packages: the closest package all
+ * of them depend on (directly or not) or are.  Packages depending on each other cyclically are
+ * equivalent, the first by name is selected among them.  If there is no common dependency or
+ * several unrelated ones are equally close, the fallback package is selected, if any.
+ */
+[[nodiscard]] static Package* common_package(const FileLevelSymbol& symbol)
+{
+    std::vector<const Package*> common;
+    auto first = true;
+    for (const auto* package : symbol.referencing_packages()) {
+        const auto& reachable = reachable_from(*package);
+        if (first) {
+            common.assign(reachable.begin(), reachable.end());
+            first = false;
+        } else {
+            common.erase(std::remove_if(common.begin(), common.end(),
+                             [&reachable](const Package* candidate) { return reachable.count(candidate) == 0; }),
+                common.end());
+        }
+    }
+
+    // Only the candidates no other candidate depends on are the closest ones
+    std::vector<const Package*> closest;
+    for (const auto* candidate : common) {
+        const auto& from_candidate = reachable_from(*candidate);
+        const auto farther = std::any_of(common.begin(), common.end(), [&](const Package* other) {
+            return other != candidate && reachable_from(*other).count(candidate) != 0 &&
+                from_candidate.count(other) == 0;
+        });
+        if (!farther) {
+            closest.push_back(candidate);
+        }
+    }
+    if (closest.empty()) {
+        return fallback_package;
+    }
+    const auto& from_first = reachable_from(*closest.front());
+    if (!std::all_of(closest.begin(), closest.end(),
+            [&from_first](const Package* candidate) { return from_first.count(candidate) != 0; })) {
+        return fallback_package;
+    }
+    const auto* selected = *std::min_element(closest.begin(), closest.end(),
+        [](const Package* lhs, const Package* rhs) { return lhs->cangjie_name() < rhs->cangjie_name(); });
+    return packages.by_cangjie_name(selected->cangjie_name());
+}
+
 class ScopeBuilderStatus final {
     bool success_ = true;
     bool changed_ = false;
@@ -104,14 +247,54 @@ public:
     }
 };
 
+/**
+ * Move the entity referenced from several packages to their common package, and make the
+ * referencing packages depend on it.  Returns false if there is no such package.
+ */
+[[nodiscard]] static bool place_in_common_package(ScopeBuilderStatus& status, FileLevelSymbol& symbol)
+{
+    auto* common = common_package(symbol);
+    if (!common) {
+        return false;
+    }
+    auto new_edges = false;
+    for (const auto* referencing : symbol.referencing_packages()) {
+        if (referencing != common && reachable_from(*referencing).count(common) == 0) {
+            packages.by_cangjie_name(referencing->cangjie_name())->add_dependency_edge(*common);
+            new_edges = true;
+        }
+    }
+    if (new_edges) {
+        reachable_packages.clear();
+    }
+    if (symbol.package() != common) {
+        if (verbosity >= LogLevel::DEBUG) {
+            std::cerr << "Entity `" << symbol.name() << "` is used from " << symbol.number_of_referencing_packages()
+                      << " packages, assigning common package `" << common->cangjie_name() << '`' << std::endl;
+        }
+        symbol.move_to_package(*common);
+        // The entities it references are to be moved as well
+        symbol.set_output_status(OutputStatus::Referenced);
+        ++placed_in_common_packages;
+        status.mark_changed();
+    }
+    return true;
+}
+
 static void add_all_symbol_references()
 {
+    TraceEvent event("add_all_symbol_references", "mark_package");
+    std::uint64_t symbols = 0;
+    std::uint64_t references = 0;
     for (const auto& input_file : inputs) {
         for (auto& symbol : input_file) {
             assert(symbol.defining_file());
             symbol.collect_referenced_symbols();
+            ++symbols;
+            references += symbol.references_symbols().size();
         }
     }
+    event.arg("symbols", symbols).arg("references", references);
 }
 
 static void set_root_reference_level() noexcept
@@ -140,6 +323,16 @@ static void symbol_references_to_packages_pass(ScopeBuilderStatus& status, FileL
             switch (reference->output_status()) {
                 case OutputStatus::Undefined:
                     assert(!reference->package());
+                    if (auto candidate_it = candidates.find(reference); candidate_it != candidates.end()) {
+                        // An unused entity matching a package filter becomes a root of its own package
+                        if (reference->reference_level() <= Config::closure_depth()) {
+                            reference->set_output_status(OutputStatus::Root);
+                            reference->register_for_package(*candidate_it->second);
+                            promoted_candidates.push_back(reference);
+                            status.mark_changed();
+                        }
+                        break;
+                    }
                     reference->set_output_status(OutputStatus::Referenced);
                     reference->add_referencing_package(*package);
                     if (reference->reference_level() <= Config::closure_depth()) {
@@ -151,11 +344,11 @@ static void symbol_references_to_packages_pass(ScopeBuilderStatus& status, FileL
                 case OutputStatus::ReferencedMarked: {
                     const auto* reference_package = reference->package();
                     if (reference_package && reference_package != package) {
-                        // It makes sense to build graph of dependencies between packages and resolve
-                        // the most common cases by selecting the closest common dependency package.
-                        reference->set_output_status(OutputStatus::MultiReferenced);
                         reference->add_referencing_package(*package);
-                        status.mark_error();
+                        if (!place_in_common_package(status, *reference)) {
+                            reference->set_output_status(OutputStatus::MultiReferenced);
+                            status.mark_error();
+                        }
                     }
                     break;
                 }
@@ -175,6 +368,14 @@ static void symbol_references_to_packages_pass(ScopeBuilderStatus& status, FileL
 {
     ScopeBuilderStatus status;
 
+    if (!roots_only) {
+        auto promoted = std::move(promoted_candidates);
+        promoted_candidates.clear();
+        for (auto* symbol : promoted) {
+            symbol_references_to_packages_pass(status, *symbol, true);
+        }
+    }
+
     for (const auto& input_file : inputs) {
         for (auto& symbol : input_file) {
             symbol_references_to_packages_pass(status, symbol, roots_only);
@@ -186,15 +387,29 @@ static void symbol_references_to_packages_pass(ScopeBuilderStatus& status, FileL
 
 [[nodiscard]] static bool symbol_references_to_packages()
 {
+    TraceEvent event("symbol_references_to_packages", "mark_package");
     set_root_reference_level();
 
+    // The dependencies between the roots are the initial graph to search common packages in
+    fallback_package = read_fallback_package();
+    placed_in_common_packages = 0;
+    reachable_packages.clear();
+    compute_package_dependencies();
+
     auto status = symbol_references_to_packages_pass(true);
     auto error = status.error();
+    std::uint64_t passes = 1;
     while (status.changed()) {
         status = symbol_references_to_packages_pass(false);
         if (status.error()) {
             error = true;
         }
+        ++passes;
+    }
+    event.arg("passes", passes).arg("placed_in_common_packages", placed_in_common_packages);
+    if (placed_in_common_packages != 0 && verbosity >= LogLevel::INFO) {
+        std::cerr << "Placed " << placed_in_common_packages
+                  << " entities used from several packages into their common packages" << std::endl;
     }
 
     for (const auto& input_file : inputs) {
@@ -211,7 +426,11 @@ static void symbol_references_to_packages_pass(ScopeBuilderStatus& status, FileL
                     if (verbosity >= LogLevel::TRACE) {
                         std::cerr << "Entity `" << symbol.name() << "` from `" << input_file.path().u8string();
                         const auto* package = symbol.package();
-                        if (package) {
+                        if (package && symbol.number_of_referencing_packages() > 1) {
+                            std::cerr << "` is used from " << symbol.number_of_referencing_packages()
+                                      << " packages, assigning `" << symbol.package_file()->output_path().u8string()
+                                      << '`';
+                        } else if (package) {
                             assert(symbol.package_file());
                             std::cerr << "` is only used from `" << package->cangjie_name() << "` package, assigning `"
                                       << symbol.package_file()->output_path().u8string() << '`';
@@ -237,15 +456,22 @@ static void symbol_references_to_packages_pass(ScopeBuilderStatus& status, FileL
 
 static void register_symbols_in_declaration_order()
 {
+    TraceEvent event("register_symbols_in_declaration_order", "mark_package");
+    std::uint64_t registered = 0;
     for (const auto& input_file : inputs) {
         for (auto& symbol : input_file) {
             assert(symbol.defining_file());
 
             if (auto* package_file = symbol.package_file()) {
                 package_file->add_symbol(symbol);
+                ++registered;
             }
         }
     }
+    for (auto&& package : packages) {
+        package.remove_empty_files();
+    }
+    event.arg("symbols", registered);
 }
 
 /** Given the N-dimensional VArray, get the type of its element */
@@ -276,6 +502,7 @@ static void decay_parameter_types(NonTypeSymbol& function)
  */
 static void decay_parameter_types()
 {
+    TraceEvent event("decay_parameter_types", "mark_package");
     auto& universe = Universe::get();
     for (auto& top_level : universe.top_level()) {
         decay_parameter_types(top_level);
@@ -0,0 +1,617 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "MultiTarget.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "Batch.h"
+#include "CangjieWriter.h"
+#include "Config.h"
+#include "FatalException.h"
+#include "Logging.h"
+#include "Strings.h"
+#include "Trace.h"
+
+namespace objcgen {
+
+const Target* current_target = nullptr;
+
+/** The file `write_target_output` writes the outputs of `current_target` to */
+static std::filesystem::path target_output_path;
+
+[[nodiscard]] static bool is_valid_target_name(const std::string& name)
+{
+    return !name.empty() && std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+    });
+}
+
+[[nodiscard]] static const std::string& target_string(
+    const toml::Table& table, std::size_t index, const std::string& property_name)
+{
+    auto property_it = table.find(property_name);
+    if (property_it == table.end()) {
+        fatal("`targets` item #", index, " has no `", property_name, "` property");
+    }
+    if (!property_it->second.is<std::string>()) {
+        fatal("`targets` item #", index, " property `", property_name, "` should be a TOML string");
+    }
+    return property_it->second.as<std::string>();
+}
+
+std::vector<Target> read_targets()
+{
+    std::vector<Target> targets;
+    const auto* targets_any = Config::find("targets");
+    if (!targets_any) {
+        return targets;
+    }
+    if (!targets_any->is<toml::Array>()) {
+        fatal("`targets` should be a TOML array of tables");
+    }
+    std::size_t i = 0;
+    for (auto&& target_any : targets_any->as<toml::Array>()) {
+        if (!target_any.is<toml::Table>()) {
+            fatal("`targets` item #", i, " is not a TOML table");
+        }
+        const auto& target_table = target_any.as<toml::Table>();
+        Target target{target_string(target_table, i, "name"), {}, target_string(target_table, i, "condition")};
+        if (!is_valid_target_name(target.name_)) {
+            fatal("`targets` item #", i, " name `", target.name_,
+                "` should consist of Latin letters, digits, `_` and `-`");
+        }
+        if (std::any_of(targets.begin(), targets.end(),
+                [&target](const auto& other) { return other.name_ == target.name_; })) {
+            fatal("`targets` item #", i, " name `", target.name_, "` is not unique");
+        }
+        if (auto arguments_it = target_table.find("arguments"); arguments_it != target_table.end()) {
+            if (!arguments_it->second.is<toml::Array>()) {
+                fatal("`targets` item #", i, " property `arguments` should be a TOML array");
+            }
+            std::size_t j = 0;
+            for (auto&& argument_any : arguments_it->second.as<toml::Array>()) {
+                if (!argument_any.is<std::string>()) {
+                    fatal("`targets` item #", i, " array `arguments` item #", j, " is not a TOML string");
+                }
+                target.arguments_.push_back(argument_any.as<std::string>());
+                j++;
+            }
+        }
+        targets.push_back(std::move(target));
+        i++;
+    }
+    // The targets having a declaration are kept in the bits of `TargetSet`
+    if (targets.size() > 64) {
+        fatal("Too many targets: ", targets.size(), ", at most 64 are supported");
+    }
+    return targets;
+}
+
+static void write_size(std::ostream& stream, std::uint64_t value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void write_string(std::ostream& stream, const std::string& value)
+{
+    write_size(stream, value.size());
+    stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+void write_target_output()
+{
+    assert(current_target);
+    auto files = render_cangjie();
+    std::ofstream stream(target_output_path, std::ios::binary);
+    write_size(stream, files.size());
+    for (const auto& file : files) {
+        write_string(stream, file.path_.u8string());
+        write_string(stream, file.package_);
+        write_size(stream, file.imports_.size());
+        for (const auto& import : file.imports_) {
+            write_string(stream, import);
+        }
+        write_string(stream, file.text_);
+        write_size(stream, file.declarations_.size());
+        for (const auto& declaration : file.declarations_) {
+            write_string(stream, declaration.key_);
+            write_size(stream, declaration.begin_);
+            write_size(stream, declaration.end_);
+            write_size(stream, declaration.members_begin_);
+            write_size(stream, declaration.members_end_);
+            write_size(stream, declaration.flat_);
+            write_size(stream, declaration.members_.size());
+            for (const auto& member : declaration.members_) {
+                write_string(stream, member.key_);
+                write_size(stream, member.begin_);
+                write_size(stream, member.end_);
+            }
+        }
+    }
+    if (!stream) {
+        fatal("Cannot write the output of target `", current_target->name_, "` to `", target_output_path.u8string(),
+            '`');
+    }
+    std::cout << "Rendered " << files.size() << " files for target `" << current_target->name_ << '`' << std::endl;
+}
+
+#ifdef _WIN32
+
+int run_targets(const std::vector<Target>&, const std::function<int()>&)
+{
+    fatal("Multiple targets are not supported on Windows");
+}
+
+#else
+
+/** Reads the file written by `write_target_output` */
+class TargetOutputReader final {
+public:
+    TargetOutputReader(const Target& target, const std::filesystem::path& path)
+        : target_(target), stream_(path, std::ios::binary)
+    {
+        if (!stream_) {
+            fatal("Cannot read the output of target `", target.name_, "` from `", path.u8string(), '`');
+        }
+    }
+
+    [[nodiscard]] std::vector<CangjieFile> read();
+
+private:
+    [[nodiscard]] std::uint64_t size()
+    {
+        std::uint64_t value = 0;
+        stream_.read(reinterpret_cast<char*>(&value), sizeof(value));
+        if (!stream_) {
+            corrupted();
+        }
+        return value;
+    }
+
+    /** A position in the text of `size` characters */
+    [[nodiscard]] std::size_t position(std::size_t size)
+    {
+        auto value = this->size();
+        if (value > size) {
+            corrupted();
+        }
+        return static_cast<std::size_t>(value);
+    }
+
+    [[nodiscard]] std::string string()
+    {
+        std::string value(static_cast<std::size_t>(size()), '\0');
+        stream_.read(value.data(), static_cast<std::streamsize>(value.size()));
+        if (!stream_) {
+            corrupted();
+        }
+        return value;
+    }
+
+    [[noreturn]] void corrupted() const
+    {
+        fatal("The output of target `", target_.name_, "` is corrupted");
+    }
+
+    const Target& target_;
+    std::ifstream stream_;
+};
+
+std::vector<CangjieFile> TargetOutputReader::read()
+{
+    std::vector<CangjieFile> files(static_cast<std::size_t>(size()));
+    for (auto& file : files) {
+        file.path_ = std::filesystem::u8path(string());
+        file.package_ = string();
+        file.imports_.resize(static_cast<std::size_t>(size()));
+        for (auto& import : file.imports_) {
+            import = string();
+        }
+        file.text_ = string();
+        const auto text_size = file.text_.size();
+        file.declarations_.resize(static_cast<std::size_t>(size()));
+        for (auto& declaration : file.declarations_) {
+            declaration.key_ = string();
+            declaration.begin_ = position(text_size);
+            declaration.end_ = position(text_size);
+            declaration.members_begin_ = position(text_size);
+            declaration.members_end_ = position(text_size);
+            declaration.flat_ = size() != 0;
+            declaration.members_.resize(static_cast<std::size_t>(size()));
+            for (auto& member : declaration.members_) {
+                member.key_ = string();
+                member.begin_ = position(text_size);
+                member.end_ = position(text_size);
+            }
+        }
+    }
+    return files;
+}
+
+/** The bits of the targets */
+using TargetSet = std::uint64_t;
+
+/**
+ * The order of the keys that keeps the order of every sequence where possible: the keys missing
+ * in the previous sequences are inserted after the preceding key of their sequence.
+ */
+class KeyOrder final {
+public:
+    void add(const std::vector<std::string>& keys)
+    {
+        auto next = order_.begin();
+        for (const auto& key : keys) {
+            if (auto it = positions_.find(key); it != positions_.end()) {
+                next = std::next(it->second);
+                continue;
+            }
+            auto inserted = order_.insert(next, key);
+            positions_.emplace(*inserted, inserted);
+        }
+    }
+
+    [[nodiscard]] const std::list<std::string>& keys() const noexcept
+    {
+        return order_;
+    }
+
+private:
+    std::list<std::string> order_;
+    // The keys point to the nodes of `order_`
+    std::unordered_map<std::string_view, std::list<std::string>::iterator> positions_;
+};
+
+/** The keys of the items, with the occurrences of a duplicate key numbered after the first one */
+template <class Item> [[nodiscard]] static std::vector<std::string> unique_keys(const std::vector<Item>& items)
+{
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, std::size_t> counts;
+    for (const auto& item : items) {
+        auto count = counts[item.key_]++;
+        keys.push_back(count == 0 ? item.key_ : item.key_ + '\n' + std::to_string(count));
+    }
+    return keys;
+}
+
+/** The texts of an item in the targets having it, grouped by the text */
+template <class Item> class Variants final {
+public:
+    void add(std::size_t target, std::string_view text, const Item& item)
+    {
+        auto it = std::find_if(
+            variants_.begin(), variants_.end(), [text](const auto& variant) { return variant.text_ == text; });
+        if (it == variants_.end()) {
+            variants_.push_back({text, &item, 0});
+            it = std::prev(variants_.end());
+        }
+        it->targets_ |= TargetSet{1} << target;
+        targets_ |= TargetSet{1} << target;
+    }
+
+    struct Variant {
+        std::string_view text_;
+        const Item* item_;
+        TargetSet targets_;
+    };
+
+    [[nodiscard]] const std::vector<Variant>& variants() const noexcept
+    {
+        return variants_;
+    }
+
+    [[nodiscard]] TargetSet targets() const noexcept
+    {
+        return targets_;
+    }
+
+private:
+    std::vector<Variant> variants_;
+    TargetSet targets_ = 0;
+};
+
+class TargetMerger final {
+public:
+    explicit TargetMerger(const std::vector<Target>& targets)
+        : targets_(targets), all_targets_(targets.size() == 64 ? ~TargetSet{0} : (TargetSet{1} << targets.size()) - 1)
+    {
+    }
+
+    /** Merge the files of all targets and write them.  Returns the number of the files. */
+    [[nodiscard]] std::size_t merge(const std::vector<std::vector<CangjieFile>>& outputs);
+
+private:
+    struct TargetFile {
+        std::size_t target_;
+        const CangjieFile* file_;
+        std::vector<std::string> keys_;
+    };
+
+    void merge_file(const std::vector<TargetFile>& target_files);
+
+    /** Write `statement` preceded by `@When` with the same indentation unless it is for all targets */
+    void write_when(std::string_view statement, TargetSet targets);
+
+    void write_declaration(const CangjieFile& file, const CangjieDeclaration& declaration, TargetSet targets);
+
+    void write_merged_declaration(const std::vector<TargetFile>& target_files,
+        const std::vector<const CangjieDeclaration*>& declarations, TargetSet targets);
+
+    [[nodiscard]] std::string condition(TargetSet targets) const;
+
+    const std::vector<Target>& targets_;
+    const TargetSet all_targets_;
+    std::string text_;
+};
+
+std::string TargetMerger::condition(TargetSet targets) const
+{
+    std::vector<const std::string*> conditions;
+    for (std::size_t i = 0; i < targets_.size(); ++i) {
+        if (targets & TargetSet{1} << i) {
+            conditions.push_back(&targets_[i].condition_);
+        }
+    }
+    if (conditions.size() == 1) {
+        return *conditions.front();
+    }
+    std::string result;
+    for (const auto* condition : conditions) {
+        if (!result.empty()) {
+            result += " || ";
+        }
+        result += '(' + *condition + ')';
+    }
+    return result;
+}
+
+void TargetMerger::write_when(std::string_view statement, TargetSet targets)
+{
+    if (targets != all_targets_) {
+        auto indentation = statement.substr(0, statement.find_first_not_of(' '));
+        text_ += indentation;
+        // A commented out declaration is followed by another one, which `@When` must not apply to
+        if (starts_with(statement.substr(indentation.size()), "//")) {
+            text_ += "// ";
+        }
+        text_ += "@When[" + condition(targets) + "]\n";
+    }
+    text_ += statement;
+}
+
+void TargetMerger::write_declaration(const CangjieFile& file, const CangjieDeclaration& declaration, TargetSet targets)
+{
+    std::string_view text = file.text_;
+    if (!declaration.flat_) {
+        write_when(text.substr(declaration.begin_, declaration.end_ - declaration.begin_), targets);
+    } else {
+        write_when(text.substr(declaration.begin_, declaration.members_begin_ - declaration.begin_), targets);
+        for (const auto& member : declaration.members_) {
+            write_when(text.substr(member.begin_, member.end_ - member.begin_), targets);
+        }
+        text_ += text.substr(declaration.members_end_, declaration.end_ - declaration.members_end_);
+    }
+    text_ += '\n';
+}
+
+void TargetMerger::write_merged_declaration(const std::vector<TargetFile>& target_files,
+    const std::vector<const CangjieDeclaration*>& declarations, TargetSet targets)
+{
+    const auto& first_file = *target_files.front().file_;
+    const auto& first = *declarations.front();
+    std::string_view first_text = first_file.text_;
+    write_when(first_text.substr(first.begin_, first.members_begin_ - first.begin_), targets);
+
+    KeyOrder member_order;
+    std::vector<std::unordered_map<std::string, const CangjieMember*>> members(target_files.size());
+    for (std::size_t i = 0; i < target_files.size(); ++i) {
+        if (const auto* declaration = declarations[i]) {
+            auto keys = unique_keys(declaration->members_);
+            for (std::size_t j = 0; j < keys.size(); ++j) {
+                members[i].emplace(keys[j], &declaration->members_[j]);
+            }
+            member_order.add(keys);
+        }
+    }
+    for (const auto& key : member_order.keys()) {
+        Variants<CangjieMember> variants;
+        for (std::size_t i = 0; i < target_files.size(); ++i) {
+            if (auto it = members[i].find(key); it != members[i].end()) {
+                const auto& member = *it->second;
+                variants.add(target_files[i].target_,
+                    std::string_view(target_files[i].file_->text_).substr(member.begin_, member.end_ - member.begin_),
+                    member);
+            }
+        }
+        for (const auto& variant : variants.variants()) {
+            // The members of a type declaration are under its condition already
+            write_when(variant.text_, !first.flat_ && variant.targets_ == targets ? all_targets_ : variant.targets_);
+        }
+    }
+
+    text_ += first_text.substr(first.members_end_, first.end_ - first.members_end_);
+    text_ += '\n';
+}
+
+void TargetMerger::merge_file(const std::vector<TargetFile>& target_files)
+{
+    const auto& first_file = *target_files.front().file_;
+    TargetSet file_targets = 0;
+    KeyOrder import_order;
+    KeyOrder declaration_order;
+    std::vector<std::unordered_map<std::string, const CangjieDeclaration*>> declarations(target_files.size());
+    for (std::size_t i = 0; i < target_files.size(); ++i) {
+        const auto& target_file = target_files[i];
+        if (target_file.file_->package_ != first_file.package_) {
+            fatal("File `", first_file.path_.u8string(), "` belongs to package `", first_file.package_,
+                "` for target `", targets_[target_files.front().target_].name_, "` and to package `",
+                target_file.file_->package_, "` for target `", targets_[target_file.target_].name_, '`');
+        }
+        file_targets |= TargetSet{1} << target_file.target_;
+        import_order.add(target_file.file_->imports_);
+        declaration_order.add(target_file.keys_);
+        for (std::size_t j = 0; j < target_file.keys_.size(); ++j) {
+            declarations[i].emplace(target_file.keys_[j], &target_file.file_->declarations_[j]);
+        }
+    }
+
+    std::vector<std::string> import_lines;
+    for (const auto& import : import_order.keys()) {
+        TargetSet import_targets = 0;
+        for (const auto& target_file : target_files) {
+            const auto& imports = target_file.file_->imports_;
+            if (std::find(imports.begin(), imports.end(), import) != imports.end()) {
+                import_targets |= TargetSet{1} << target_file.target_;
+            }
+        }
+        import_lines.push_back(
+            (import_targets == all_targets_ ? std::string() : "@When[" + condition(import_targets) + "]\n") +
+            "import " + import);
+    }
+
+    text_.clear();
+    for (const auto& key : declaration_order.keys()) {
+        Variants<CangjieDeclaration> variants;
+        std::vector<const CangjieDeclaration*> key_declarations(target_files.size());
+        std::vector<const CangjieFile*> variant_files;
+        for (std::size_t i = 0; i < target_files.size(); ++i) {
+            if (auto it = declarations[i].find(key); it != declarations[i].end()) {
+                const auto& declaration = *it->second;
+                key_declarations[i] = &declaration;
+                auto variant_count = variants.variants().size();
+                variants.add(target_files[i].target_,
+                    std::string_view(target_files[i].file_->text_)
+                        .substr(declaration.begin_, declaration.end_ - declaration.begin_),
+                    declaration);
+                if (variants.variants().size() != variant_count) {
+                    variant_files.push_back(target_files[i].file_);
+                }
+            }
+        }
+
+        const auto& variant_list = variants.variants();
+        if (variant_list.size() == 1) {
+            write_declaration(*variant_files.front(), *variant_list.front().item_, variants.targets());
+            continue;
+        }
+
+        // Merge the members if the declarations differ in them only
+        auto frame = [&variant_list, &variant_files](std::size_t i) {
+            const auto& declaration = *variant_list[i].item_;
+            std::string_view text = variant_files[i]->text_;
+            return std::make_tuple(declaration.flat_,
+                text.substr(declaration.begin_, declaration.members_begin_ - declaration.begin_),
+                text.substr(declaration.members_end_, declaration.end_ - declaration.members_end_));
+        };
+        auto same_frames = true;
+        for (std::size_t i = 1; i < variant_list.size(); ++i) {
+            if (frame(i) != frame(0)) {
+                same_frames = false;
+                break;
+            }
+        }
+        if (same_frames) {
+            std::vector<TargetFile> present_files;
+            std::vector<const CangjieDeclaration*> present_declarations;
+            for (std::size_t i = 0; i < target_files.size(); ++i) {
+                if (key_declarations[i]) {
+                    present_files.push_back(target_files[i]);
+                    present_declarations.push_back(key_declarations[i]);
+                }
+            }
+            write_merged_declaration(present_files, present_declarations, variants.targets());
+        } else {
+            for (std::size_t i = 0; i < variant_list.size(); ++i) {
+                write_declaration(*variant_files[i], *variant_list[i].item_, variant_list[i].targets_);
+            }
+        }
+    }
+
+    write_cangjie_file(first_file.path_, first_file.package_, import_lines, text_);
+    if (verbosity >= LogLevel::INFO && file_targets != all_targets_) {
+        std::cerr << "File `" << first_file.path_.u8string() << "` is generated for the targets `"
+                  << condition(file_targets) << '`' << std::endl;
+    }
+}
+
+std::size_t TargetMerger::merge(const std::vector<std::vector<CangjieFile>>& outputs)
+{
+    KeyOrder path_order;
+    std::map<std::string, std::vector<TargetFile>> files_by_path;
+    for (std::size_t target = 0; target < outputs.size(); ++target) {
+        std::vector<std::string> paths;
+        for (const auto& file : outputs[target]) {
+            auto path = file.path_.u8string();
+            files_by_path[path].push_back({target, &file, unique_keys(file.declarations_)});
+            paths.push_back(std::move(path));
+        }
+        path_order.add(paths);
+    }
+    for (const auto& path : path_order.keys()) {
+        TraceEvent event("Merge " + std::filesystem::u8path(path).filename().u8string(), "write");
+        merge_file(files_by_path.at(path));
+    }
+    return files_by_path.size();
+}
+
+int run_targets(const std::vector<Target>& targets, const std::function<int()>& generate)
+{
+    std::vector<std::filesystem::path> output_paths;
+    std::vector<int> pids;
+    auto temp_directory = std::filesystem::temp_directory_path();
+    for (const auto& target : targets) {
+        output_paths.push_back(temp_directory /
+            ("ObjCInteropGen-" + std::to_string(getpid()) + '-' + target.name_ + ".targetout"));
+        target_output_path = output_paths.back();
+        pids.push_back(start_forked([&target, &generate] {
+            if (verbosity >= LogLevel::INFO) {
+                std::cerr << "Generating for target `" << target.name_ << '`' << std::endl;
+            }
+            current_target = &target;
+            return generate();
+        }));
+    }
+
+    auto status = 0;
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        if (wait_forked(pids[i]) != 0) {
+            std::cerr << "Generation for target `" << targets[i].name_ << "` has failed" << std::endl;
+            status = 1;
+        }
+    }
+
+    if (status == 0) {
+        TraceEvent event("merge_targets");
+        std::vector<std::vector<CangjieFile>> outputs;
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            outputs.push_back(TargetOutputReader(targets[i], output_paths[i]).read());
+        }
+        auto file_count = TargetMerger(targets).merge(outputs);
+        event.arg("files", file_count);
+        std::cout << "Generated " << file_count << " files for " << targets.size() << " targets" << std::endl;
+    }
+    for (const auto& path : output_paths) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+    return status;
+}
+
+#endif
+
+} // namespace objcgen
@@ -0,0 +1,47 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef MULTITARGET_H
+#define MULTITARGET_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace objcgen {
+
+/** An item of `[[targets]]` */
+struct Target {
+    std::string name_;
+    /** The Clang arguments added to the arguments of every source */
+    std::vector<std::string> arguments_;
+    /** The `@When` condition of the declarations that are specific to the target */
+    std::string condition_;
+};
+
+/** The target the current process generates for, or null if the configuration has no targets */
+extern const Target* current_target;
+
+/** Read `[[targets]]` of the current configuration.  Returns an empty vector if there are none. */
+[[nodiscard]] std::vector<Target> read_targets();
+
+/**
+ * Run `generate` for all targets at once, each in a forked process with `current_target` set.
+ * `generate` parses the sources and writes the outputs with `write_target_output`.  Then the
+ * outputs of the targets are merged by the symbol names into a single set of Cangjie files, where
+ * the declarations and members that differ between the targets are marked with `@When`.
+ *
+ * Returns 0 if all targets have succeeded.  Needs `fork`, so it is not supported on Windows.
+ */
+[[nodiscard]] int run_targets(const std::vector<Target>& targets, const std::function<int()>& generate);
+
+/** Save the rendered Cangjie files of `current_target` for `run_targets` to merge */
+void write_target_output();
+
+} // namespace objcgen
+
+#endif // MULTITARGET_H
@@ -15,26 +15,34 @@ namespace objcgen {
 
 Packages packages;
 
-const std::string& PackageFilter::package_name() const noexcept
-{
-    return package_.cangjie_name();
-}
-
 PackageFile::PackageFile(std::string file_name, Package& package)
     : output_path_(package.output_path() + '/' + file_name + ".cj"), package_(&package)
 {
     assert(!file_name.empty());
 }
 
-static void create_package(std::size_t package_index, const toml::Table& config)
+/** The `packages` entry #`package_index` with its `package-name` and `filters` validated */
+struct PackageEntry {
+    const toml::Table& config_;
+    std::string cangjie_name_;
+    std::string name_desc_;
+    const toml::Table& filters_;
+};
+
+[[nodiscard]] static PackageEntry read_package_entry(std::size_t package_index, const toml::Value& package_any)
 {
+    if (!package_any.is<toml::Table>()) {
+        fatal("`packages` entry #", package_index, " is not a TOML table");
+    }
+    const auto& config = package_any.as<toml::Table>();
+
     std::string name_desc = '#' + std::to_string(package_index);
 
     auto package_cangjie_name_opt = get_string_value(config, name_desc, "package-name");
     if (!package_cangjie_name_opt) {
         fatal("`packages` entry ", name_desc, " should define `package-name` property");
     }
-    const auto& package_cangjie_name = *package_cangjie_name_opt;
+    auto& package_cangjie_name = *package_cangjie_name_opt;
 
     name_desc = '`' + package_cangjie_name + '`';
 
@@ -45,31 +53,53 @@ static void create_package(std::size_t package_index, const toml::Table& config)
     if (!filters_it->second.is<toml::Table>()) {
         fatal("`packages` entry ", name_desc, " property `filters` should be a TOML table");
     }
-    if (packages.by_cangjie_name(package_cangjie_name)) {
-        fatal("There are multiple `packages` entries with the same `package-name` value `", package_cangjie_name, '`');
-    }
+    return {config, std::move(package_cangjie_name), std::move(name_desc), filters_it->second.as<toml::Table>()};
+}
 
-    auto& package = *new Package(package_cangjie_name, compute_output_path(name_desc, config, package_cangjie_name));
-    package.set_filters(create_filter(package, filters_it->second.as<toml::Table>()));
+[[nodiscard]] static Package& new_package(std::size_t package_index, const toml::Value& package_any)
+{
+    auto entry = read_package_entry(package_index, package_any);
+    auto& package = *new Package(
+        entry.cangjie_name_, compute_output_path(entry.name_desc_, entry.config_, entry.cangjie_name_));
+    package.set_filters(create_filter(entry.cangjie_name_, entry.filters_));
+    return package;
+}
 
-    packages.insert(package);
+[[nodiscard]] static const toml::Array& packages_config()
+{
+    const auto* packages = Config::find("packages");
+    if (!packages || !packages->is<toml::Array>()) {
+        fatal("`packages` should be a TOML array of tables");
+    }
+    return packages->as<toml::Array>();
 }
 
 void create_packages()
 {
-    if (const auto* packages = Config::find("packages")) {
-        std::size_t i = 0;
-        for (auto&& package_any : packages->as<toml::Array>()) {
-            if (!package_any.is<toml::Table>()) {
-                fatal("`packages` entry #", i, " is not a TOML table");
-            }
-            // It makes sense to consider supporting packages-mixins
-            create_package(i, package_any.as<toml::Table>());
-            i++;
+    std::size_t i = 0;
+    for (auto&& package_any : packages_config()) {
+        // It makes sense to consider supporting packages-mixins
+        auto& package = new_package(i, package_any);
+        if (packages.by_cangjie_name(package.cangjie_name())) {
+            fatal("There are multiple `packages` entries with the same `package-name` value `",
+                package.cangjie_name(), '`');
         }
-    } else {
-        fatal("`packages` should be a TOML array of tables");
+        packages.insert(package);
+        i++;
+    }
+}
+
+std::vector<const PackageFilter*> read_package_filters()
+{
+    std::vector<const PackageFilter*> filters;
+    std::size_t i = 0;
+    for (auto&& package_any : packages_config()) {
+        // Only the filters are needed, so no `Package` is created and no output path is computed
+        auto entry = read_package_entry(i, package_any);
+        filters.push_back(&create_filter(entry.cangjie_name_, entry.filters_));
+        i++;
     }
+    return filters;
 }
 
 } // namespace objcgen
@@ -9,6 +9,7 @@
 #define SCOPE_H
 
 #include <cassert>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <string_view>
@@ -23,7 +24,7 @@ class Package;
 
 class PackageFilter : NonCopyable {
 protected:
-    explicit PackageFilter(const Package& package) noexcept : package_(package)
+    explicit PackageFilter(std::string package_name) noexcept : package_name_(std::move(package_name))
     {
     }
 
@@ -32,21 +33,21 @@ public:
 
     [[nodiscard]] virtual bool apply(std::string_view entity_name) const = 0;
 
-    [[nodiscard]] const Package& package() const noexcept
+    /** The `package-name` of the package the filter belongs to, for diagnostics */
+    [[nodiscard]] const std::string& package_name() const noexcept
     {
-        return package_;
+        return package_name_;
     }
 
-    [[nodiscard]] const std::string& package_name() const noexcept;
-
 private:
-    const Package& package_;
+    const std::string package_name_;
 };
 
 class PackageFile final {
     std::filesystem::path output_path_;
     Package* const package_;
     std::vector<FileLevelSymbol*> symbols_;
+    std::uint64_t size_ = 0;
 
 public:
     PackageFile(std::string file_name, Package& package);
@@ -67,6 +68,22 @@ public:
         symbols_.push_back(&symbol);
     }
 
+    [[nodiscard]] std::size_t symbol_count() const noexcept
+    {
+        return symbols_.size();
+    }
+
+    /** The number of bytes written to `output_path()`, or 0 if the file is not written yet */
+    [[nodiscard]] std::uint64_t size() const noexcept
+    {
+        return size_;
+    }
+
+    void set_size(std::uint64_t size) noexcept
+    {
+        size_ = size;
+    }
+
     [[nodiscard]] auto begin() const noexcept
     {
         return symbols_.begin();
@@ -153,12 +170,30 @@ public:
         return *it->second;
     }
 
+    /** Remove the files left without symbols after moving their symbols to other packages */
+    void remove_empty_files()
+    {
+        for (auto it = files_.begin(); it != files_.end();) {
+            if (it->second->symbol_count() == 0) {
+                delete it->second;
+                it = files_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     void add_dependency_edge(Package& package)
     {
         assert(&package != this);
         depends_on_.emplace(&package);
     }
 
+    void clear_dependency_edges() noexcept
+    {
+        depends_on_.clear();
+    }
+
     [[nodiscard]] PackageFile* operator[](const std::string& name) const
     {
         const auto it = files_.find(name);
@@ -251,6 +286,12 @@ extern Packages packages;
 
 void create_packages();
 
+/**
+ * The filters of the `packages` entries, for matching the entity names before `create_packages`
+ * (while parsing the sources).  The packages of the filters are not registered.
+ */
+[[nodiscard]] std::vector<const PackageFilter*> read_package_filters();
+
 } // namespace objcgen
 
 #endif // SCOPE_H
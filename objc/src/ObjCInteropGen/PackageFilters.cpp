@@ -15,12 +15,12 @@
 namespace objcgen {
 
 [[nodiscard]] static std::regex create_regex(
-    const Package& package, const std::string& pattern, std::string_view mode_name)
+    const std::string& package_name, const std::string& pattern, std::string_view mode_name)
 {
     try {
         return std::regex(pattern);
     } catch (const std::regex_error& e) {
-        fatal("`packages` entry `", package.cangjie_name(), "` ", mode_name, " filter (`", pattern,
+        fatal("`packages` entry `", package_name, "` ", mode_name, " filter (`", pattern,
             "`) has thrown an error: ", describe_regex_error(e.code()));
     }
 }
@@ -31,10 +31,10 @@ class RegexFilter final : public PackageFilter {
     const std::string_view mode_name_; // "include"/"exclude"/"filter"/"filter-not", only for better diagnostics
 
 public:
-    explicit RegexFilter(const Package& package, std::string pattern, const std::string_view mode_name)
-        : PackageFilter(package),
+    explicit RegexFilter(const std::string& package_name, std::string pattern, const std::string_view mode_name)
+        : PackageFilter(package_name),
           pattern_(std::move(pattern)),
-          regex_(create_regex(package, pattern_, mode_name)),
+          regex_(create_regex(package_name, pattern_, mode_name)),
           mode_name_(mode_name)
     {
     }
@@ -61,7 +61,8 @@ class NotFilter final : public PackageFilter {
     const PackageFilter& filter_;
 
 public:
-    NotFilter(const Package& package, const PackageFilter& filter) noexcept : PackageFilter(package), filter_(filter)
+    NotFilter(const std::string& package_name, const PackageFilter& filter)
+        : PackageFilter(package_name), filter_(filter)
     {
     }
 
@@ -86,7 +87,7 @@ public:
 protected:
     std::vector<const PackageFilter*> arguments_;
 
-    SetOperationFilter(const Package& package) noexcept : PackageFilter(package)
+    SetOperationFilter(const std::string& package_name) : PackageFilter(package_name)
     {
     }
 };
@@ -96,7 +97,7 @@ class UnionFilter final : public SetOperationFilter {
 public:
     static constexpr auto mode_name = "union";
 
-    UnionFilter(const Package& package) noexcept : SetOperationFilter(package)
+    UnionFilter(const std::string& package_name) : SetOperationFilter(package_name)
     {
     }
 
@@ -116,7 +117,7 @@ class IntersectionFilter final : public SetOperationFilter {
 public:
     static constexpr auto mode_name = "intersect";
 
-    IntersectionFilter(const Package& package) noexcept : SetOperationFilter(package)
+    IntersectionFilter(const std::string& package_name) : SetOperationFilter(package_name)
     {
     }
 
@@ -132,73 +133,73 @@ public:
 };
 
 [[nodiscard]] static PackageFilter& create_regex_filter(
-    const Package& package, const toml::Value& node, std::string_view mode_name)
+    const std::string& package_name, const toml::Value& node, std::string_view mode_name)
 {
     if (verbosity >= LogLevel::DIAGNOSTIC) {
-        std::cerr << "`packages` entry `" << package.cangjie_name() << "` " << mode_name << " filter" << std::endl;
+        std::cerr << "`packages` entry `" << package_name << "` " << mode_name << " filter" << std::endl;
     }
 
     if (node.is<std::string>()) {
-        return *new RegexFilter(package, node.as<std::string>(), mode_name);
+        return *new RegexFilter(package_name, node.as<std::string>(), mode_name);
     }
 
     if (!node.is<toml::Array>()) {
-        fatal("`packages` entry `", package.cangjie_name(), "` ", mode_name,
+        fatal("`packages` entry `", package_name, "` ", mode_name,
             " filter must be a TOML string or an array of TOML strings");
     }
-    auto& result = *new UnionFilter(package);
+    auto& result = *new UnionFilter(package_name);
 
     std::size_t i = 0;
     for (auto&& item_any : node.as<toml::Array>()) {
         if (!item_any.is<std::string>()) {
-            fatal("`packages` entry `", package.cangjie_name(), "` ", mode_name, " filter #", i,
+            fatal("`packages` entry `", package_name, "` ", mode_name, " filter #", i,
                 " must be a TOML string");
         }
-        result.add_argument(*new RegexFilter(package, item_any.as<std::string>(), mode_name));
+        result.add_argument(*new RegexFilter(package_name, item_any.as<std::string>(), mode_name));
         i++;
     }
 
     if (result.empty()) {
-        fatal("`packages` entry `", package.cangjie_name(), "` ", mode_name, " filter array has no items");
+        fatal("`packages` entry `", package_name, "` ", mode_name, " filter array has no items");
     }
 
     return result;
 }
 
 template <class SetOperationFilter>
-[[nodiscard]] static SetOperationFilter& create_set_filter(const Package& package, const toml::Value& node)
+[[nodiscard]] static SetOperationFilter& create_set_filter(const std::string& package_name, const toml::Value& node)
 {
     if (verbosity >= LogLevel::DIAGNOSTIC) {
-        std::cerr << "`packages` entry `" << package.cangjie_name() << "` " << SetOperationFilter::mode_name
+        std::cerr << "`packages` entry `" << package_name << "` " << SetOperationFilter::mode_name
                   << " filter" << std::endl;
     }
 
     if (!node.is<toml::Array>()) {
-        fatal("`packages` entry `", package.cangjie_name(), "` ", SetOperationFilter::mode_name,
+        fatal("`packages` entry `", package_name, "` ", SetOperationFilter::mode_name,
             " filter must be an array of filters");
     }
 
-    auto& result = *new SetOperationFilter(package);
+    auto& result = *new SetOperationFilter(package_name);
 
     std::size_t i = 0;
     for (auto&& item_any : node.as<toml::Array>()) {
         if (!item_any.is<toml::Table>()) {
-            fatal("`packages` entry `", package.cangjie_name(), "` ", SetOperationFilter::mode_name, " filter #", i,
+            fatal("`packages` entry `", package_name, "` ", SetOperationFilter::mode_name, " filter #", i,
                 " must be a TOML table");
         }
-        result.add_argument(create_filter(package, item_any.as<toml::Table>()));
+        result.add_argument(create_filter(package_name, item_any.as<toml::Table>()));
         i++;
     }
 
     if (result.empty()) {
-        fatal("`packages` entry `", package.cangjie_name(), "` ", SetOperationFilter::mode_name,
+        fatal("`packages` entry `", package_name, "` ", SetOperationFilter::mode_name,
             " filter array has no items");
     }
 
     return result;
 }
 
-PackageFilter& create_filter(const Package& package, const toml::Table& table)
+PackageFilter& create_filter(const std::string& package_name, const toml::Table& table)
 {
     auto e = table.end();
     auto include_it = table.find("include");
@@ -225,47 +226,47 @@ PackageFilter& create_filter(const Package& package, const toml::Table& table)
 
     switch (non_null) {
         case 0:
-            fatal("`packages` entry `", package.cangjie_name(),
+            fatal("`packages` entry `", package_name,
                 "` filter has no specified operations (like include, union, etc)");
         case 1: {
             PackageFilter* result;
             if (include_it != e) {
-                result = &create_regex_filter(package, include_it->second, "include");
+                result = &create_regex_filter(package_name, include_it->second, "include");
             } else if (exclude_it != e) {
-                result = new NotFilter(package, create_regex_filter(package, exclude_it->second, "exclude"));
+                result = new NotFilter(package_name, create_regex_filter(package_name, exclude_it->second, "exclude"));
             } else if (set_union_it != e) {
-                result = &create_set_filter<UnionFilter>(package, set_union_it->second);
+                result = &create_set_filter<UnionFilter>(package_name, set_union_it->second);
             } else if (set_intersect_it != e) {
-                result = &create_set_filter<IntersectionFilter>(package, set_intersect_it->second);
+                result = &create_set_filter<IntersectionFilter>(package_name, set_intersect_it->second);
             } else {
                 assert(set_not_it != e);
                 const auto& set_not = set_not_it->second;
                 if (!set_not.is<toml::Table>()) {
-                    fatal("`packages` entry `", package.cangjie_name(), "` not filter must be a TOML table");
+                    fatal("`packages` entry `", package_name, "` not filter must be a TOML table");
                 }
-                result = new NotFilter(package, create_filter(package, set_not.as<toml::Table>()));
+                result = new NotFilter(package_name, create_filter(package_name, set_not.as<toml::Table>()));
             }
 
             if (filter_it == e && filter_not_it == e) {
                 return *result;
             }
 
-            auto& intersect = *new IntersectionFilter(package);
+            auto& intersect = *new IntersectionFilter(package_name);
             intersect.add_argument(*result);
 
             if (filter_it != e) {
-                intersect.add_argument(create_regex_filter(package, filter_it->second, "filter"));
+                intersect.add_argument(create_regex_filter(package_name, filter_it->second, "filter"));
             }
 
             if (filter_not_it != e) {
-                intersect.add_argument(
-                    *new NotFilter(package, create_regex_filter(package, filter_not_it->second, "filter-not")));
+                intersect.add_argument(*new NotFilter(
+                    package_name, create_regex_filter(package_name, filter_not_it->second, "filter-not")));
             }
 
             return intersect;
         }
         default:
-            fatal("`packages` entry `", package.cangjie_name(), "` filter has ", non_null,
+            fatal("`packages` entry `", package_name, "` filter has ", non_null,
                 " operations, but only 1 is allowed simultaneously");
     }
 }
@@ -0,0 +1,309 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "PackageGraph.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+#include "FatalException.h"
+#include "InputFile.h"
+#include "JsonWriter.h"
+#include "Package.h"
+
+namespace objcgen {
+
+void compute_package_dependencies()
+{
+    for (auto&& package : packages) {
+        package.clear_dependency_edges();
+    }
+    for (const auto& input_file : inputs) {
+        for (const auto& symbol : input_file) {
+            if (auto* package_file = symbol.package_file()) {
+                auto& edge_from = package_file->package();
+                for (const auto* reference : symbol.references_symbols()) {
+                    if (auto* edge_to = reference->package()) {
+                        if (&edge_from != edge_to) {
+                            edge_from.add_dependency_edge(*edge_to);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void print_package_dependencies()
+{
+    std::unordered_map<const Package*, std::size_t> fan_in;
+    for (auto&& package : packages) {
+        for (const auto* dependency : package.depends_on()) {
+            ++fan_in[dependency];
+        }
+    }
+    for (auto&& package : packages) {
+        std::cout << "Package `" << package.cangjie_name() << "` is imported by " << fan_in[&package]
+                  << " packages" << std::endl;
+        auto& depends_on = package.depends_on();
+        std::cout << "Package `" << package.cangjie_name() << "` depends on " << depends_on.size();
+        if (depends_on.size() == 1) {
+            auto* dependency = *depends_on.begin();
+            std::cout << " package: `" << dependency->cangjie_name() << '`' << std::endl;
+        } else if (depends_on.size() > 1) {
+            std::cout << " packages:" << std::endl;
+            for (auto* dependency : depends_on) {
+                std::cout << "* " << dependency->cangjie_name() << std::endl;
+            }
+        } else {
+            std::cout << " packages" << std::endl;
+        }
+    }
+}
+
+/**
+ * Snapshot of the package dependency graph with the nodes ordered by the package name.  The
+ * strongly connected components are collapsed (Tarjan's algorithm), so the topological level is
+ * defined even if the packages depend on each other cyclically.
+ */
+class PackageGraph final {
+    static constexpr std::size_t UNVISITED = std::numeric_limits<std::size_t>::max();
+
+    struct Node {
+        Package* package_;
+        std::vector<std::size_t> depends_on_;
+        std::size_t index_ = UNVISITED;
+        std::size_t low_link_ = UNVISITED;
+        std::size_t component_ = UNVISITED;
+        std::size_t level_ = 0;
+        bool on_stack_ = false;
+        /** The number of packages depending on this one */
+        std::size_t fan_in_ = 0;
+    };
+
+public:
+    PackageGraph()
+    {
+        for (auto&& package : packages) {
+            nodes_.push_back(Node{&package, {}});
+        }
+        std::sort(nodes_.begin(), nodes_.end(),
+            [](const Node& lhs, const Node& rhs) { return lhs.package_->cangjie_name() < rhs.package_->cangjie_name(); });
+        std::unordered_map<const Package*, std::size_t> index_by_package;
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {
+            index_by_package.emplace(nodes_[i].package_, i);
+        }
+        for (auto& node : nodes_) {
+            for (auto* dependency : node.package_->depends_on()) {
+                const auto index = index_by_package.at(dependency);
+                node.depends_on_.push_back(index);
+                ++nodes_[index].fan_in_;
+            }
+            std::sort(node.depends_on_.begin(), node.depends_on_.end());
+        }
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i].index_ == UNVISITED) {
+                strong_connect(i);
+            }
+        }
+    }
+
+    void write(JsonWriter& json) const;
+
+private:
+    void strong_connect(std::size_t v);
+
+    [[nodiscard]] const std::string& name(std::size_t v) const noexcept
+    {
+        return nodes_[v].package_->cangjie_name();
+    }
+
+    void write_names(JsonWriter& json, const std::vector<std::size_t>& indices) const
+    {
+        json.begin_array();
+        for (auto index : indices) {
+            json.string(name(index));
+        }
+        json.end_array();
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<std::vector<std::size_t>> components_;
+    std::vector<std::size_t> stack_;
+    std::size_t next_index_ = 0;
+};
+
+void PackageGraph::strong_connect(std::size_t v)
+{
+    nodes_[v].index_ = nodes_[v].low_link_ = next_index_++;
+    stack_.push_back(v);
+    nodes_[v].on_stack_ = true;
+    for (auto w : nodes_[v].depends_on_) {
+        if (nodes_[w].index_ == UNVISITED) {
+            strong_connect(w);
+            nodes_[v].low_link_ = std::min(nodes_[v].low_link_, nodes_[w].low_link_);
+        } else if (nodes_[w].on_stack_) {
+            nodes_[v].low_link_ = std::min(nodes_[v].low_link_, nodes_[w].index_);
+        }
+    }
+    if (nodes_[v].low_link_ != nodes_[v].index_) {
+        return;
+    }
+
+    // The components are completed in the reverse topological order, so the levels of all the
+    // dependencies outside of this component are already known.
+    auto component = components_.size();
+    auto& members = components_.emplace_back();
+    std::size_t w;
+    do {
+        w = stack_.back();
+        stack_.pop_back();
+        nodes_[w].on_stack_ = false;
+        nodes_[w].component_ = component;
+        members.push_back(w);
+    } while (w != v);
+    std::sort(members.begin(), members.end());
+
+    std::size_t level = 0;
+    for (auto member : members) {
+        for (auto dependency : nodes_[member].depends_on_) {
+            if (nodes_[dependency].component_ != component) {
+                level = std::max(level, nodes_[dependency].level_ + 1);
+            }
+        }
+    }
+    for (auto member : members) {
+        nodes_[member].level_ = level;
+    }
+}
+
+void PackageGraph::write(JsonWriter& json) const
+{
+    std::size_t level_count = 0;
+    for (const auto& node : nodes_) {
+        level_count = std::max(level_count, node.level_ + 1);
+    }
+
+    json.key("packages").begin_array();
+    for (std::size_t v = 0; v < nodes_.size(); ++v) {
+        const auto& node = nodes_[v];
+        const auto& package = *node.package_;
+        std::vector<const PackageFile*> files;
+        for (auto&& package_file : package) {
+            files.push_back(&package_file);
+        }
+        std::sort(files.begin(), files.end(),
+            [](const PackageFile* lhs, const PackageFile* rhs) { return lhs->output_path() < rhs->output_path(); });
+        std::uint64_t size = 0;
+        std::size_t declarations = 0;
+        for (const auto* file : files) {
+            size += file->size();
+            declarations += file->symbol_count();
+        }
+
+        json.begin_object();
+        json.key("name").string(package.cangjie_name());
+        json.key("output_path").string(package.output_path());
+        json.key("level").number(node.level_);
+        json.key("size").number(size);
+        json.key("declarations").number(declarations);
+        json.key("fan_in").number(node.fan_in_);
+        json.key("fan_out").number(node.depends_on_.size());
+        json.key("depends_on");
+        write_names(json, node.depends_on_);
+        json.key("files").begin_array();
+        for (const auto* file : files) {
+            json.begin_object();
+            json.key("path").string(file->output_path().generic_u8string());
+            json.key("size").number(file->size());
+            json.key("declarations").number(file->symbol_count());
+            json.end_object();
+        }
+        json.end_array();
+        json.end_object();
+    }
+    json.end_array();
+
+    json.key("edges").begin_array();
+    for (std::size_t v = 0; v < nodes_.size(); ++v) {
+        for (auto w : nodes_[v].depends_on_) {
+            json.begin_object();
+            json.key("from").string(name(v));
+            json.key("to").string(name(w));
+            json.end_object();
+        }
+    }
+    json.end_array();
+
+    // Packages of the same level do not depend on each other and can be compiled in parallel
+    json.key("levels").begin_array();
+    for (std::size_t level = 0; level < level_count; ++level) {
+        std::vector<std::size_t> level_nodes;
+        for (std::size_t v = 0; v < nodes_.size(); ++v) {
+            if (nodes_[v].level_ == level) {
+                level_nodes.push_back(v);
+            }
+        }
+        write_names(json, level_nodes);
+    }
+    json.end_array();
+
+    // The longest dependency chain, starting from the package that has to be compiled last
+    std::vector<std::size_t> critical_path;
+    if (!nodes_.empty()) {
+        auto v = static_cast<std::size_t>(
+            std::max_element(nodes_.begin(), nodes_.end(),
+                [](const Node& lhs, const Node& rhs) { return lhs.level_ < rhs.level_; }) -
+            nodes_.begin());
+        critical_path.push_back(v);
+        while (nodes_[v].level_ != 0) {
+            // The level of a cycle can be defined by a dependency of any of its members
+            auto next = UNVISITED;
+            for (auto member : components_[nodes_[v].component_]) {
+                for (auto w : nodes_[member].depends_on_) {
+                    if (nodes_[w].level_ + 1 == nodes_[v].level_) {
+                        next = std::min(next, w);
+                    }
+                }
+            }
+            assert(next != UNVISITED);
+            v = next;
+            critical_path.push_back(v);
+        }
+    }
+    json.key("critical_path");
+    write_names(json, critical_path);
+
+    json.key("cycles").begin_array();
+    for (const auto& members : components_) {
+        if (members.size() > 1) {
+            write_names(json, members);
+        }
+    }
+    json.end_array();
+}
+
+void write_package_manifest(const std::filesystem::path& path)
+{
+    PackageGraph graph;
+
+    std::ofstream output(path);
+    if (!output) {
+        fatal("Cannot write package manifest `", path.u8string(), '`');
+    }
+    JsonWriter json(output);
+    json.begin_object();
+    graph.write(json);
+    json.end_object();
+    if (!output) {
+        fatal("Cannot write package manifest `", path.u8string(), '`');
+    }
+}
+
+} // namespace objcgen
@@ -0,0 +1,33 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef PACKAGEGRAPH_H
+#define PACKAGEGRAPH_H
+
+#include <filesystem>
+
+namespace objcgen {
+
+/**
+ * (Re)build the dependency edges between the packages from the references of the symbols
+ * assigned to them.
+ */
+void compute_package_dependencies();
+
+/** Print the package dependencies computed by `compute_package_dependencies()` to `std::cout` */
+void print_package_dependencies();
+
+/**
+ * Write the JSON manifest describing the generated packages: their files, the dependency edges
+ * with the import fan-in and fan-out, the topological build levels and the sizes of the generated
+ * code.
+ */
+void write_package_manifest(const std::filesystem::path& path);
+
+} // namespace objcgen
+
+#endif // PACKAGEGRAPH_H
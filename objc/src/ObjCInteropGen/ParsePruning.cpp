@@ -0,0 +1,124 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "ParsePruning.h"
+
+#include <iostream>
+
+#include "Config.h"
+#include "FatalException.h"
+#include "Logging.h"
+#include "Package.h"
+
+namespace objcgen {
+
+/** Append the value to `key` in a form that does not depend on the TOML formatting */
+static void append_canonical(std::string& key, const toml::Value& value)
+{
+    if (value.is<std::string>()) {
+        const auto& string = value.as<std::string>();
+        key += 's' + std::to_string(string.size()) + ':' + string;
+    } else if (value.is<bool>()) {
+        key += value.as<bool>() ? "T" : "F";
+    } else if (value.is<int64_t>()) {
+        key += 'i' + std::to_string(value.as<int64_t>()) + ';';
+    } else if (value.is<toml::Array>()) {
+        key += '[';
+        for (auto&& item : value.as<toml::Array>()) {
+            append_canonical(key, item);
+        }
+        key += ']';
+    } else if (value.is<toml::Table>()) {
+        key += '{';
+        for (auto&& [name, item] : value.as<toml::Table>()) {
+            append_canonical(key, name);
+            append_canonical(key, item);
+        }
+        key += '}';
+    } else {
+        key += '?';
+    }
+}
+
+std::shared_ptr<const ParsePruning> ParsePruning::create()
+{
+    const auto* pruning_any = Config::find("parse-pruning");
+    if (!pruning_any) {
+        return nullptr;
+    }
+    if (!pruning_any->is<toml::Table>()) {
+        fatal("`parse-pruning` should be a TOML table");
+    }
+    const auto& pruning_table = pruning_any->as<toml::Table>();
+    if (auto enabled_it = pruning_table.find("enabled"); enabled_it != pruning_table.end()) {
+        if (!enabled_it->second.is<bool>()) {
+            fatal("`parse-pruning` property `enabled` should be a TOML boolean");
+        }
+        if (!enabled_it->second.as<bool>()) {
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<ParsePruning> pruning(new ParsePruning);
+    pruning->filters_ = read_package_filters();
+    for (auto&& package_any : Config::find("packages")->as<toml::Array>()) {
+        append_canonical(pruning->key_, *package_any.find("filters"));
+    }
+
+    if (auto external_it = pruning_table.find("external"); external_it != pruning_table.end()) {
+        toml::Array patterns;
+        if (external_it->second.is<std::string>()) {
+            patterns.push_back(external_it->second);
+        } else if (external_it->second.is<toml::Array>()) {
+            patterns = external_it->second.as<toml::Array>();
+        } else {
+            fatal("`parse-pruning` property `external` must be a TOML string or an array of TOML strings");
+        }
+        std::size_t i = 0;
+        for (auto&& pattern_any : patterns) {
+            if (!pattern_any.is<std::string>()) {
+                fatal("`parse-pruning` array `external` item #", i, " is not a TOML string");
+            }
+            const auto& pattern = pattern_any.as<std::string>();
+            try {
+                pruning->external_.emplace_back(pattern);
+            } catch (const std::regex_error& e) {
+                fatal("`parse-pruning` array `external` item #", i, " (`", pattern,
+                    "`) has thrown an error: ", describe_regex_error(e.code()));
+            }
+            append_canonical(pruning->key_, pattern);
+            i++;
+        }
+    }
+
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Parse pruning is enabled with " << pruning->filters_.size() << " package filters and "
+                  << pruning->external_.size() << " external patterns" << std::endl;
+    }
+    return pruning;
+}
+
+bool ParsePruning::is_wanted(const std::string& name) const
+{
+    auto [it, inserted] = wanted_.try_emplace(name, false);
+    if (inserted) {
+        for (const auto* filter : filters_) {
+            if (filter->apply(name)) {
+                it->second = true;
+                return true;
+            }
+        }
+        for (const auto& regex : external_) {
+            if (std::regex_match(name, regex)) {
+                it->second = true;
+                return true;
+            }
+        }
+    }
+    return it->second;
+}
+
+} // namespace objcgen
@@ -0,0 +1,53 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef PARSEPRUNING_H
+#define PARSEPRUNING_H
+
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace objcgen {
+
+class PackageFilter;
+
+/**
+ * The names of the declarations the scanner builds the symbols of eagerly when `[parse-pruning]`
+ * is enabled: the names matching any package filter or any `external` pattern.  The rest of the
+ * Objective-C classes, protocols and categories are recorded as stubs, which get their members
+ * only if a wanted declaration references them (directly or not), and the rest of the functions
+ * are skipped.
+ */
+class ParsePruning final {
+public:
+    /** Read `[parse-pruning]` and the package filters.  Returns null if the pruning is not enabled. */
+    [[nodiscard]] static std::shared_ptr<const ParsePruning> create();
+
+    [[nodiscard]] bool is_wanted(const std::string& name) const;
+
+    /** The canonical form of the configuration, equal for the configurations with the same pruning */
+    [[nodiscard]] const std::string& key() const noexcept
+    {
+        return key_;
+    }
+
+private:
+    ParsePruning() = default;
+
+    std::vector<const PackageFilter*> filters_;
+    std::vector<std::regex> external_;
+    std::string key_;
+    mutable std::unordered_map<std::string, bool> wanted_;
+};
+
+} // namespace objcgen
+
+#endif // PARSEPRUNING_H
@@ -6,16 +6,26 @@
 
 #include "ClangSession.h"
 
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <iostream>
 #include <optional>
+#include <set>
 #include <stack>
+#include <unordered_map>
 
 #include <clang-c/Index.h>
+#include <clang/AST/Attr.h>
 #include <clang/AST/DeclObjC.h>
 #include <clang/Basic/Version.h>
 
 #include "FatalException.h"
 #include "Logging.h"
+#include "ParsePruning.h"
+#include "SourceScannerConfig.h"
 #include "Strings.h"
+#include "Trace.h"
 #include "Universe.h"
 
 [[nodiscard]] static bool operator==(const CXType& lhs, const CXType& rhs) noexcept
@@ -44,6 +54,29 @@ public:
         clang_visitChildren(cursor, visit, this);
     }
 
+    /**
+     * Visit the translation unit of the source unit #`unit_index`.  With `pruning`, the
+     * declarations that are not wanted are left as stubs, and the stubs referenced from the wanted
+     * declarations get their members before returning, while the cursors are still valid.
+     */
+    void visit_translation_unit(const CXCursor& cursor, std::size_t unit_index, const ParsePruning* pruning);
+
+    /**
+     * The unit to parse again because a stub recorded while visiting it has become referenced
+     * after its translation unit was disposed.
+     */
+    [[nodiscard]] std::optional<std::size_t> unit_to_reparse();
+
+    [[nodiscard]] std::size_t pruned_count() const noexcept
+    {
+        return pruned_count_;
+    }
+
+    [[nodiscard]] std::size_t completed_stub_count() const noexcept
+    {
+        return completed_stubs_.size();
+    }
+
 private:
     // See the comment in the 'get_owner_generic_type' method
     TypeDeclarationSymbol* last_interface_decl_ = nullptr;
@@ -70,6 +103,30 @@ private:
     // Symbol Resolution (USR).
     std::unordered_set<std::string> visited_symbols_;
 
+    // Parse pruning state.  A pruned interface, protocol, or category leaves the stub
+    // symbol without members, and its cursor waits in `pending_` until the end of the
+    // translation unit.  `stub_units_` keeps the unit where each stub was last pruned
+    // to parse it again if the stub is referenced later.
+    const ParsePruning* pruning_ = nullptr;
+    std::size_t unit_index_ = 0;
+    CXCursor translation_unit_ = clang_getNullCursor();
+    std::vector<std::pair<CXCursor, TypeDeclarationSymbol*>> pending_;
+    std::unordered_map<TypeDeclarationSymbol*, std::size_t> stub_units_;
+    std::unordered_set<const TypeDeclarationSymbol*> completed_stubs_;
+    std::set<std::size_t> units_to_reparse_;
+    std::size_t pruned_count_ = 0;
+
+    // The reachability walk of `complete_stubs`, kept across translation units so that
+    // every unit walks only what it has added.  The top-level functions and types before
+    // `seeded_functions_` and `seeded_types_` have already been considered as roots, and
+    // `touched_types_` are the types whose declarations were visited since the last walk,
+    // so their new members and bases have to be walked again.
+    std::unordered_set<FileLevelSymbol*> reached_;
+    std::deque<FileLevelSymbol*> reach_queue_;
+    std::size_t seeded_functions_ = 0;
+    std::size_t seeded_types_ = 0;
+    std::unordered_set<NamedTypeSymbol*> touched_types_;
+
     [[nodiscard]] NamedTypeSymbol* current_type() const noexcept
     {
         return current_.empty() ? nullptr : current_.top();
@@ -131,6 +188,12 @@ private:
     // anymore.
     [[nodiscard]] bool is_fully_processed(const CXCursor& cursor);
 
+    /** Returns true if the top-level `cursor` is not wanted and is left for later (or skipped) */
+    [[nodiscard]] bool prune(const CXCursor& cursor, CXCursorKind cursor_kind);
+
+    /** Give the members to the pending stubs reachable from the wanted declarations */
+    void complete_stubs();
+
     void visit_impl(const CXCursor& cursor, const CXCursor& parent);
 
     /**
@@ -145,6 +208,9 @@ private:
 class ClangSessionImpl final : public ClangSession, private NonCopyable {
     CXIndex index_;
     SourceScanner scanner_;
+    std::set<std::string> included_files_;
+    // The units parsed so far, to parse them again if their pruned declarations get needed
+    std::vector<SourceUnit> units_;
 
 public:
     ClangSessionImpl()
@@ -165,7 +231,16 @@ public:
     }
 
 private:
-    void parse_sources(const std::vector<std::string>& files, const std::vector<std::string>& arguments) override;
+    void parse_sources(const std::vector<SourceUnit>& units) override;
+
+    void parse_unit(std::size_t unit_index);
+
+    void reparse_units(const SourceUnit& unit);
+
+    [[nodiscard]] std::vector<std::string> included_files() const override
+    {
+        return {included_files_.begin(), included_files_.end()};
+    }
 };
 
 std::unique_ptr<ClangSession> ClangSession::create()
@@ -265,6 +340,16 @@ static std::ostream& operator<<(std::ostream& stream, const String& string)
     return clang_equalLocations(loc, clang_getNullLocation());
 }
 
+// The absolute paths of the files of the translation unit being visited.  Getting the name of a
+// file from libclang allocates a CXString, and making it absolute queries the current directory,
+// which adds up for every declaration.  CXFile handles are valid within their translation unit
+// only, so the cache is cleared after visiting it.
+//
+// The paths are normalized: the declarations deserialized from a Clang module have the paths the
+// headers were found by when the module was built, like `Foo.framework/Headers/../Headers/Foo.h`,
+// and the same header has to be the same input file however it was reached.
+static std::unordered_map<CXFile, std::filesystem::path> file_paths;
+
 [[nodiscard]] static Location get_location(const CXCursor& decl)
 {
     assert(is_valid(decl));
@@ -278,10 +363,12 @@ static std::ostream& operator<<(std::ostream& stream, const String& string)
     if (!file) {
         return {};
     }
-    location.file_ = as_string(clang_getFileName(file));
-    if (!location.file_.is_absolute()) {
-        location.file_ = std::filesystem::absolute(location.file_);
+    auto [it, inserted] = file_paths.try_emplace(file);
+    if (inserted) {
+        std::filesystem::path path = as_string(clang_getFileName(file));
+        it->second = (path.is_absolute() ? path : std::filesystem::absolute(path)).lexically_normal();
     }
+    location.file_ = it->second;
     return location;
 }
 
@@ -315,6 +402,25 @@ template <class Decl>
     return clang::QualType::getFromOpaquePtr(type.data[0]);
 }
 
+/**
+ * The spelling of the cursor, like `clang_getCursorSpelling`.  The names of the declarations
+ * named by an identifier and the selectors of the methods are taken from the AST directly, without
+ * a CXString round trip.
+ */
+[[nodiscard]] static std::string spelling(const CXCursor& cursor)
+{
+    if (clang_isDeclaration(cursor.kind)) {
+        const auto* decl = static_cast<const clang::Decl*>(cursor.data[0]);
+        if (const auto* method = llvm::dyn_cast_or_null<clang::ObjCMethodDecl>(decl)) {
+            return method->getSelector().getAsString();
+        }
+        if (const auto* named = llvm::dyn_cast_or_null<clang::NamedDecl>(decl); named && named->getIdentifier()) {
+            return named->getName().str();
+        }
+    }
+    return as_string(clang_getCursorSpelling(cursor));
+}
+
 Type SourceScanner::create_func_like_type(BuiltInTypeSymbol& func_like_symbol, const CXType& type)
 {
     assert(type.kind == CXType_FunctionProto || type.kind == CXType_FunctionNoProto);
@@ -418,12 +524,12 @@ template <CXTypeKind type_kind> Type SourceScanner::get_named_type(const CXType&
 
     std::string name;
     if constexpr (type_kind == CXType_Unexposed) {
-        name = as_string(is_valid(decl) ? clang_getCursorSpelling(decl) : clang_getTypeSpelling(type));
+        name = is_valid(decl) ? spelling(decl) : as_string(clang_getTypeSpelling(type));
     } else if constexpr (type_kind == CXType_Record || type_kind == CXType_Enum) {
         if (unnamed) {
             name = new_anonymous_name(decl);
         } else {
-            name = as_string(clang_getCursorSpelling(decl));
+            name = spelling(decl);
             if (name.empty()) {
                 // This must be an unnamed (but not anonymous) struct/union/enum declared inside
                 // a typedef declaration, like this:
@@ -435,7 +541,7 @@ template <CXTypeKind type_kind> Type SourceScanner::get_named_type(const CXType&
             }
         }
     } else {
-        name = as_string(clang_getCursorSpelling(decl));
+        name = spelling(decl);
     }
     assert(!name.empty());
 
@@ -521,17 +627,36 @@ template <CXTypeKind type_kind> Type SourceScanner::get_named_type(const CXType&
 [[nodiscard]] static TypeDeclarationSymbol& get_type_declaration(const CXCursor& cursor, NamedTypeSymbol::Kind kind)
 {
     auto& universe = Universe::get();
-    String name(clang_getCursorSpelling(cursor));
-    auto* result = universe.type(kind, name.string_view());
+    auto name = spelling(cursor);
+    auto* result = universe.type(kind, name);
     if (result) {
         return result->as<TypeDeclarationSymbol>();
     }
-    auto& new_result = *new TypeDeclarationSymbol(kind, name.string());
+    auto& new_result = *new TypeDeclarationSymbol(kind, std::move(name));
     universe.register_type(new_result);
     set_definition_location(cursor, new_result);
     return new_result;
 }
 
+/** The interface extended by the category under `cursor` */
+[[nodiscard]] static TypeDeclarationSymbol& category_interface(const CXCursor& cursor)
+{
+    assert(clang_getCursorKind(cursor) == CXCursor_ObjCCategoryDecl);
+    CXCursor interface_cursor = clang_getNullCursor();
+    clang_visitChildren(
+        cursor,
+        [](CXCursor cursor, CXCursor, CXClientData client_data) {
+            if (clang_getCursorKind(cursor) != CXCursor_ObjCClassRef) {
+                return CXChildVisit_Recurse;
+            }
+            *static_cast<CXCursor*>(client_data) = clang_getCursorReferenced(cursor);
+            return CXChildVisit_Break; // Stop visiting once found
+        },
+        &interface_cursor);
+    assert(!clang_Cursor_isNull(interface_cursor));
+    return get_type_declaration(interface_cursor, NamedTypeSymbol::Kind::Interface);
+}
+
 [[nodiscard]] static TypeDeclarationSymbol& protocol_symbol(const CXType& objc_object_type, unsigned i)
 {
     assert(objc_object_type.kind == CXType_ObjCObject);
@@ -895,8 +1020,11 @@ std::vector<ParameterSymbol> SourceScanner::get_function_parameters(const CXCurs
     parameters.reserve(n);
     for (unsigned i = 0; i < n; ++i) {
         auto param_cursor = clang_Cursor_getArgument(function_cursor, i);
-        parameters.emplace_back(
-            as_string(clang_getCursorSpelling(param_cursor)), type_like_symbol(clang_getCursorType(param_cursor)));
+        auto& parameter =
+            parameters.emplace_back(spelling(param_cursor), type_like_symbol(clang_getCursorType(param_cursor)));
+        if (cursor_to_decl<clang::ParmVarDecl>(param_cursor).hasAttr<clang::NSConsumedAttr>()) {
+            parameter.set_consumed();
+        }
     }
     return parameters;
 }
@@ -905,7 +1033,7 @@ void SourceScanner::add_top_level_function(const CXCursor& cursor)
 {
     assert(is_on_top_level());
     set_definition_location(cursor,
-        Universe::get().register_top_level_function(as_string(clang_getCursorSpelling(cursor)),
+        Universe::get().register_top_level_function(spelling(cursor),
             type_like_symbol(clang_getCursorResultType(cursor)), get_function_parameters(cursor),
             clang_getCursorLinkage(cursor) == CXLinkage_Internal ? ModifierInternalLinkage : 0));
 }
@@ -942,20 +1070,53 @@ Type SourceScanner::get_method_result_type(
     return get_method_result_type(decl, clang_getCursorResultType(method_cursor), nullability);
 }
 
+// The ownership of the method result by its family, overridden by the `ns_returns_retained`
+// and `ns_returns_not_retained` attributes
+[[nodiscard]] static Modifiers get_ownership_modifiers(const CXCursor& cursor) noexcept
+{
+    const auto& method = cursor_to_decl<clang::ObjCMethodDecl>(cursor);
+    bool family_retained;
+    switch (method.getMethodFamily()) {
+        case clang::ObjCMethodFamily::OMF_alloc:
+        case clang::ObjCMethodFamily::OMF_copy:
+        case clang::ObjCMethodFamily::OMF_init:
+        case clang::ObjCMethodFamily::OMF_mutableCopy:
+        case clang::ObjCMethodFamily::OMF_new:
+            family_retained = true;
+            break;
+        default:
+            family_retained = false;
+            break;
+    }
+    auto retained = family_retained;
+    if (method.hasAttr<clang::NSReturnsRetainedAttr>()) {
+        retained = true;
+    } else if (method.hasAttr<clang::NSReturnsNotRetainedAttr>()) {
+        retained = false;
+    }
+    Modifiers modifiers = retained ? ModifierReturnsRetained : 0;
+    if (retained != family_retained) {
+        modifiers |= ModifierOwnershipAttributed;
+    }
+    if (method.hasAttr<clang::ObjCReturnsInnerPointerAttr>()) {
+        modifiers |= ModifierReturnsInnerPointer;
+    }
+    return modifiers;
+}
+
 void SourceScanner::add_member_method(const CXCursor& cursor, Modifiers modifiers)
 {
     assert(!is_on_top_level());
     auto& decl = get_target_type_declaration();
-    decl.add_member_method(as_string(clang_getCursorSpelling(cursor)), get_method_result_type(decl, cursor),
-        get_function_parameters(cursor), modifiers);
+    decl.add_member_method(spelling(cursor), get_method_result_type(decl, cursor), get_function_parameters(cursor),
+        modifiers | get_ownership_modifiers(cursor));
 }
 
 void SourceScanner::add_constructor(const CXCursor& cursor)
 {
     assert(!is_on_top_level());
     auto& decl = get_target_type_declaration();
-    decl.add_constructor(as_string(clang_getCursorSpelling(cursor)), get_method_result_type(decl, cursor),
-        get_function_parameters(cursor));
+    decl.add_constructor(spelling(cursor), get_method_result_type(decl, cursor), get_function_parameters(cursor));
 }
 
 [[nodiscard]] static std::array<uint64_t, 2> get_enum_constant_value(const CXCursor& cursor)
@@ -970,6 +1131,12 @@ void SourceScanner::add_constructor(const CXCursor& cursor)
 void SourceScanner::visit(const CXCursor& cursor, NamedTypeSymbol& symbol)
 {
     current_.push(&symbol);
+    if (pruning_) {
+        touched_types_.insert(&symbol);
+        if (symbol.is(NamedTypeSymbol::Kind::Category)) {
+            touched_types_.insert(&symbol.as<CategoryDeclarationSymbol>().interface());
+        }
+    }
     switch (symbol.kind()) {
         case NamedTypeSymbol::Kind::Interface:
         case NamedTypeSymbol::Kind::Category:
@@ -1079,6 +1246,10 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
         return;
     }
 
+    if (prune(cursor, cursor_kind)) {
+        return;
+    }
+
     switch (cursor_kind) {
         case CXCursor_TypedefDecl: {
             assert(is_on_top_level());
@@ -1137,7 +1308,7 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
             assert(is_canonical(cursor));
             assert(is_defining(cursor));
 
-            decl.add_parameter(as_string(clang_getCursorSpelling(cursor)));
+            decl.add_parameter(spelling(cursor));
             break;
         }
         case CXCursor_ObjCCategoryDecl: {
@@ -1147,21 +1318,7 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
             assert(is_canonical(cursor));
             assert(is_defining(cursor));
 
-            CXCursor interface_cursor = clang_getNullCursor();
-            clang_visitChildren(
-                cursor,
-                [](CXCursor cursor, CXCursor, CXClientData client_data) {
-                    if (clang_getCursorKind(cursor) != CXCursor_ObjCClassRef) {
-                        return CXChildVisit_Recurse;
-                    }
-                    *static_cast<CXCursor*>(client_data) = clang_getCursorReferenced(cursor);
-                    return CXChildVisit_Break; // Stop visiting once found
-                },
-                &interface_cursor);
-            assert(!clang_Cursor_isNull(interface_cursor));
-            visit(cursor,
-                *new CategoryDeclarationSymbol(as_string(clang_getCursorSpelling(cursor)),
-                    get_type_declaration(interface_cursor, NamedTypeSymbol::Kind::Interface)));
+            visit(cursor, *new CategoryDeclarationSymbol(spelling(cursor), category_interface(cursor)));
             break;
         }
         case CXCursor_StructDecl:
@@ -1260,8 +1417,7 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
             if (clang_Cursor_isObjCOptional(cursor)) {
                 modifiers |= ModifierOptional;
             }
-            add_property(as_string(clang_getCursorSpelling(cursor)),
-                as_string(clang_Cursor_getObjCPropertyGetterName(cursor)),
+            add_property(spelling(cursor), as_string(clang_Cursor_getObjCPropertyGetterName(cursor)),
                 as_string(clang_Cursor_getObjCPropertySetterName(cursor)), modifiers);
             break;
         }
@@ -1278,11 +1434,11 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
                     break;
                 case clang::ObjCIvarDecl::AccessControl::Public:
                     get_target_type_declaration().add_instance_variable(
-                        as_string(clang_getCursorSpelling(cursor)), type_like_symbol(clang_getCursorType(cursor)));
+                        spelling(cursor), type_like_symbol(clang_getCursorType(cursor)));
                     break;
                 default:
                     assert(access_control == clang::ObjCIvarDecl::AccessControl::Protected);
-                    get_target_type_declaration().add_instance_variable(as_string(clang_getCursorSpelling(cursor)),
+                    get_target_type_declaration().add_instance_variable(spelling(cursor),
                         type_like_symbol(clang_getCursorType(cursor)), ModifierProtected);
                     break;
             }
@@ -1292,15 +1448,14 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
             assert(!is_on_top_level());
             assert(is_canonical(cursor));
             assert(is_defining(cursor));
-            current_type_declaration().add_field(as_string(clang_getCursorSpelling(cursor)),
-                type_like_symbol(clang_getCursorType(cursor)), clang_Cursor_isBitField(cursor) ? ModifierBitField : 0);
+            current_type_declaration().add_field(spelling(cursor), type_like_symbol(clang_getCursorType(cursor)),
+                clang_Cursor_isBitField(cursor) ? ModifierBitField : 0);
             break;
         case CXCursor_EnumConstantDecl:
             assert(!is_on_top_level());
             assert(is_canonical(cursor));
             assert(is_defining(cursor));
-            current_type()->as<EnumDeclarationSymbol>().add_constant(
-                as_string(clang_getCursorSpelling(cursor)), get_enum_constant_value(cursor));
+            current_type()->as<EnumDeclarationSymbol>().add_constant(spelling(cursor), get_enum_constant_value(cursor));
             break;
         case CXCursor_FunctionDecl:
             add_top_level_function(cursor);
@@ -1319,12 +1474,173 @@ void SourceScanner::visit_impl(const CXCursor& cursor, const CXCursor& parent)
     }
 }
 
+/**
+ * Whether the declaration under `cursor` contains structs, unions, or enums.  Those are always
+ * visited in place, as the names of the anonymous ones depend on the visiting order.
+ */
+[[nodiscard]] static bool declares_tags(const CXCursor& cursor)
+{
+    bool result = false;
+    clang_visitChildren(
+        cursor,
+        [](CXCursor cursor, CXCursor, CXClientData client_data) {
+            switch (clang_getCursorKind(cursor)) {
+                case CXCursor_StructDecl:
+                case CXCursor_UnionDecl:
+                case CXCursor_EnumDecl:
+                    *static_cast<bool*>(client_data) = true;
+                    return CXChildVisit_Break;
+                default:
+                    return CXChildVisit_Recurse;
+            }
+        },
+        &result);
+    return result;
+}
+
+bool SourceScanner::prune(const CXCursor& cursor, CXCursorKind cursor_kind)
+{
+    if (!pruning_ || !is_on_top_level()) {
+        return false;
+    }
+    TypeDeclarationSymbol* stub;
+    switch (cursor_kind) {
+        case CXCursor_FunctionDecl:
+            // Functions are never referenced by other declarations, so a function that is
+            // not wanted is not needed at all.
+            if (pruning_->is_wanted(spelling(cursor))) {
+                return false;
+            }
+            ++pruned_count_;
+            return true;
+        case CXCursor_ObjCInterfaceDecl:
+            stub = &get_type_declaration(cursor, NamedTypeSymbol::Kind::Interface);
+            break;
+        case CXCursor_ObjCProtocolDecl:
+            stub = &get_type_declaration(cursor, NamedTypeSymbol::Kind::Protocol);
+            break;
+        case CXCursor_ObjCCategoryDecl:
+            stub = &category_interface(cursor);
+            break;
+        default:
+            return false;
+    }
+    if (completed_stubs_.count(stub) != 0 || pruning_->is_wanted(stub->name()) || declares_tags(cursor)) {
+        return false;
+    }
+    // Forget the USR to visit the cursor again if the stub gets completed
+    visited_symbols_.erase(as_string(clang_getCursorUSR(cursor)));
+    pending_.emplace_back(cursor, stub);
+    stub_units_[stub] = unit_index_;
+    ++pruned_count_;
+    return true;
+}
+
+void SourceScanner::complete_stubs()
+{
+    // Nothing can be completed yet.  The new roots and touched types wait for the next walk.
+    if (pending_.empty() && stub_units_.empty()) {
+        return;
+    }
+
+    auto reach = [this](FileLevelSymbol& symbol) {
+        if (reached_.insert(&symbol).second) {
+            reach_queue_.push_back(&symbol);
+        }
+    };
+    auto& universe = Universe::get();
+    // The functions are roots and never change after they are added, so each is walked once
+    auto functions = universe.top_level();
+    for (auto it = std::next(functions.begin(), static_cast<std::ptrdiff_t>(seeded_functions_));
+        it != functions.end(); ++it, ++seeded_functions_) {
+        it->for_each_referenced_type(reach);
+    }
+    for (auto type_count = universe.type_count(); seeded_types_ < type_count; ++seeded_types_) {
+        auto& type = universe.type_at(seeded_types_);
+        if (type.defining_file() && pruning_->is_wanted(type.name())) {
+            reach(type);
+        }
+    }
+    for (auto* type : touched_types_) {
+        if (reached_.count(type) != 0) {
+            reach_queue_.push_back(type);
+        }
+    }
+    touched_types_.clear();
+
+    for (;;) {
+        while (!reach_queue_.empty()) {
+            auto* symbol = reach_queue_.front();
+            reach_queue_.pop_front();
+            symbol->for_each_referenced_type(reach);
+        }
+
+        // Keep the declaration order of the cursors visited now
+        auto ready_begin = std::stable_partition(pending_.begin(), pending_.end(),
+            [this](const auto& pending) { return reached_.count(pending.second) == 0; });
+        if (ready_begin == pending_.end()) {
+            break;
+        }
+        std::vector ready(ready_begin, pending_.end());
+        pending_.erase(ready_begin, pending_.end());
+        for (auto&& [cursor, stub] : ready) {
+            completed_stubs_.insert(stub);
+            stub_units_.erase(stub);
+        }
+        for (auto&& [cursor, stub] : ready) {
+            visit_impl(cursor, translation_unit_);
+            // The members are new, walk the stub once again
+            reach_queue_.push_back(stub);
+        }
+        // The completed declarations can extend other reached types, like categories do
+        for (auto* type : touched_types_) {
+            if (reached_.count(type) != 0) {
+                reach_queue_.push_back(type);
+            }
+        }
+        touched_types_.clear();
+    }
+
+    // The remaining reached stubs were pruned in the translation units already disposed
+    for (auto&& [stub, unit_index] : stub_units_) {
+        if (reached_.count(stub) != 0) {
+            units_to_reparse_.insert(unit_index);
+        }
+    }
+}
+
+void SourceScanner::visit_translation_unit(const CXCursor& cursor, std::size_t unit_index, const ParsePruning* pruning)
+{
+    pruning_ = pruning;
+    unit_index_ = unit_index;
+    translation_unit_ = cursor;
+    visit(cursor);
+    if (pruning_) {
+        complete_stubs();
+    }
+    pending_.clear();
+    translation_unit_ = clang_getNullCursor();
+}
+
+std::optional<std::size_t> SourceScanner::unit_to_reparse()
+{
+    if (units_to_reparse_.empty()) {
+        return std::nullopt;
+    }
+    auto unit_index = *units_to_reparse_.begin();
+    units_to_reparse_.erase(units_to_reparse_.begin());
+    // The stubs still not needed are recorded again while visiting the unit
+    for (auto it = stub_units_.begin(); it != stub_units_.end();) {
+        it = it->second == unit_index ? stub_units_.erase(it) : std::next(it);
+    }
+    return unit_index;
+}
+
 class TranslationUnit {
 public:
-    TranslationUnit(CXIndex index, const std::string& file, const std::vector<const char*>& args)
-        : tu_(clang_parseTranslationUnit(index, file.c_str(), args.data(), static_cast<int>(args.size()), nullptr, 0,
-              CXTranslationUnit_KeepGoing | CXTranslationUnit_VisitImplicitAttributes |
-                  CXTranslationUnit_IncludeAttributedTypes))
+    TranslationUnit(CXIndex index, const std::string& file, const std::vector<const char*>& args, unsigned options)
+        : tu_(clang_parseTranslationUnit(
+              index, file.c_str(), args.data(), static_cast<int>(args.size()), nullptr, 0, options))
     {
     }
 
@@ -1342,14 +1658,46 @@ private:
     const CXTranslationUnit tu_;
 };
 
-[[nodiscard]] static bool parse_source(
-    CXIndex index, const std::string& file, std::vector<const char*>& args, SourceScanner& visitor)
+static void add_inclusion(CXFile included_file, CXSourceLocation*, unsigned, CXClientData included_files)
+{
+    static_cast<std::set<std::string>*>(included_files)->insert(as_string(clang_getFileName(included_file)));
+}
+
+[[nodiscard]] static std::unique_ptr<TranslationUnit> parse_translation_unit(CXIndex index, const SourceUnit& unit)
 {
+    const auto& file = unit.file_;
     assert(!file.empty());
-    TranslationUnit tu(index, file, args);
+    std::vector args = {
+        "-xobjective-c",
+        "-fobjc-nonfragile-abi", // Required by GNUstep built for non-fragile ABI
+        "-fobjc-arc",            // Prevents adding low-level staff like retain/release/NSAutoreleasePool
+        "-fblocks"               // Required by GNUstep on Windows if blocks are processed
+    };
+
+    for (auto&& argument : unit.arguments_) {
+        args.push_back(argument.c_str());
+    }
+
+    TraceEvent parse_event("Parse " + std::filesystem::path(file).filename().u8string(), "parse");
+    parse_event.arg("path", file);
+    unsigned options = CXTranslationUnit_KeepGoing | CXTranslationUnit_VisitImplicitAttributes |
+        CXTranslationUnit_IncludeAttributedTypes;
+    if (unit.skip_function_bodies_) {
+        // The scanner never visits the bodies (see `CXCursor_CompoundStmt` in `visit_impl`), so
+        // only the declarations are parsed.  CXTranslationUnit_LimitSkipFunctionBodiesToPreamble
+        // is not used: without a precompiled preamble, it would disable the skipping entirely.
+        options |= CXTranslationUnit_SkipFunctionBodies;
+    }
+    return std::make_unique<TranslationUnit>(index, file, args, options);
+}
+
+[[nodiscard]] static bool visit_translation_unit(CXTranslationUnit tu, const SourceUnit& unit,
+    std::size_t unit_index, SourceScanner& visitor, std::set<std::string>& included_files)
+{
     if (!tu) {
         return false;
     }
+    clang_getInclusions(tu, add_inclusion, &included_files);
     auto numDiagnostics = clang_getNumDiagnostics(tu);
     for (unsigned i = 0; i < numDiagnostics; ++i) {
         switch (clang_getDiagnosticSeverity(clang_getDiagnostic(tu, i))) {
@@ -1361,34 +1709,58 @@ private:
         }
     }
 
-    visitor.visit(clang_getTranslationUnitCursor(tu));
+    const auto& file = unit.file_;
+    TraceEvent visit_event("Visit " + std::filesystem::path(file).filename().u8string(), "visit");
+    const auto& universe = Universe::get();
+    const auto types_before = universe.types().size();
+    const auto functions_before = universe.top_level().size();
+    const auto pruned_before = visitor.pruned_count();
+    const auto completed_before = visitor.completed_stub_count();
+    visitor.visit_translation_unit(clang_getTranslationUnitCursor(tu), unit_index, unit.pruning_.get());
+    // The headers of the modules are not reported by clang_getInclusions, as they are read from
+    // the module cache
+    for (const auto& file_path : file_paths) {
+        included_files.insert(file_path.second.u8string());
+    }
+    file_paths.clear();
+    visit_event.arg("path", file)
+        .arg("new_types", universe.types().size() - types_before)
+        .arg("new_functions", universe.top_level().size() - functions_before);
+    if (unit.pruning_) {
+        visit_event.arg("pruned", visitor.pruned_count() - pruned_before)
+            .arg("completed_stubs", visitor.completed_stub_count() - completed_before);
+    }
     return true;
 }
 
-void ClangSessionImpl::parse_sources(const std::vector<std::string>& files, const std::vector<std::string>& arguments)
+void ClangSessionImpl::parse_unit(std::size_t unit_index)
 {
-    std::vector args = {
-        "-xobjective-c",
-        "-fobjc-nonfragile-abi", // Required by GNUstep built for non-fragile ABI
-        "-fobjc-arc",            // Prevents adding low-level staff like retain/release/NSAutoreleasePool
-        "-fblocks"               // Required by GNUstep on Windows if blocks are processed
-    };
-
-    for (auto&& argument : arguments) {
-        args.push_back(argument.c_str());
+    const auto& unit = units_[unit_index];
+    if (!visit_translation_unit(*parse_translation_unit(index_, unit), unit, unit_index, scanner_, included_files_)) {
+        fatal("Parsing failed because of compiler errors");
     }
+}
 
-    auto all_file_names_are_empty = true;
-    for (auto&& file : files) {
-        if (!file.empty()) {
-            all_file_names_are_empty = false;
-            if (!parse_source(index_, file, args, scanner_)) {
-                fatal("Parsing failed because of compiler errors");
-            }
+void ClangSessionImpl::reparse_units(const SourceUnit& unit)
+{
+    while (auto unit_index = scanner_.unit_to_reparse()) {
+        if (verbosity >= LogLevel::INFO) {
+            std::cerr << "Parsing `" << units_[*unit_index].file_ << "` again for the stubs referenced from `"
+                      << unit.file_ << '`' << std::endl;
         }
+        TraceEvent reparse_event("Reparse", "parse");
+        reparse_event.arg("path", units_[*unit_index].file_);
+        parse_unit(*unit_index);
     }
-    if (all_file_names_are_empty) {
-        fatal("No input files");
+}
+
+void ClangSessionImpl::parse_sources(const std::vector<SourceUnit>& units)
+{
+    for (const auto& unit : units) {
+        units_.push_back(unit);
+        // The unit is disposed right after visiting, before the next one is parsed
+        parse_unit(units_.size() - 1);
+        reparse_units(unit);
     }
 }
 
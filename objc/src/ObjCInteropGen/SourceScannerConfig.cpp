@@ -7,13 +7,16 @@
 #include "SourceScannerConfig.h"
 
 #include <cassert>
+#include <filesystem>
 #include <iostream>
+#include <optional>
 #include <regex>
 
 #include "ClangSession.h"
 #include "Config.h"
 #include "FatalException.h"
 #include "Logging.h"
+#include "MultiTarget.h"
 
 namespace objcgen {
 
@@ -42,81 +45,47 @@ static void toml_array_to_vector(const toml::Table& table, const std::string& so
     }
 }
 
-[[nodiscard]] static bool is_mixin_applicable(
-    const std::string& source_name, const std::string& mixin_name, const toml::Array& mixin_sources_array)
-{
-    if (verbosity >= LogLevel::DIAGNOSTIC) {
-        std::cerr << "`sources-mixins` entry `" << mixin_name
-                  << "` is being being checked for applicability to `sources` entry `" << source_name << '`'
-                  << std::endl;
-    }
-
-    std::size_t i = 0;
-    for (auto&& mixin_source_any : mixin_sources_array) {
-        if (!mixin_source_any.is<std::string>()) {
-            fatal("`sources-mixins` entry `", mixin_name, "` array `sources` item #", i, " is not a TOML string");
-        }
-        const auto& mixin_source_string = mixin_source_any.as<std::string>();
-        try {
-            auto mixin_source_regex = std::regex(mixin_source_string);
-            const auto regex_match = std::regex_match(source_name.begin(), source_name.end(), mixin_source_regex);
-            if (verbosity >= LogLevel::DEBUG) {
-                std::cerr << "`sources-mixins` entry `" << mixin_name << "` array `sources` item #" << i << " (`"
-                          << mixin_source_string << "`) does" << (regex_match ? "" : " NOT") << " match source `"
-                          << source_name << '`' << std::endl;
-            }
-            if (regex_match) {
-                return true;
-            }
-        } catch (const std::regex_error& e) {
-            fatal("`sources-mixins` entry `", mixin_name, "` array `sources` item #", i, " (`", mixin_source_string,
-                "`) has thrown an error: ", describe_regex_error(e.code()));
-        }
-        i++;
-    }
-    return false;
-}
+/** A `sources-mixins` entry with its `sources` patterns compiled */
+struct SourceMixin {
+    std::string name_;
+    std::vector<std::pair<std::string, std::regex>> sources_;
+    std::vector<std::string> arguments_prepend_;
+    std::vector<std::string> arguments_append_;
+    std::optional<bool> skip_function_bodies_;
+};
 
-static void merge_array_property(toml::Table& current, const toml::Table& mixin, const std::string& source_name,
-    const std::string& mixin_name, const std::string& property_name)
+static void read_mixin_array_property(const toml::Table& mixin, const std::string& mixin_name,
+    const std::string& property_name, std::vector<std::string>& results)
 {
-    auto& current_array = current.try_emplace(property_name, toml::Array()).first->second;
-    if (!current_array.is<toml::Array>()) {
-        fatal("`sources` entry `", source_name, "` property `", property_name, "` should be a TOML array");
-    }
-
-    // Merge by appending mixin value to current value
     auto mixin_it = mixin.find(property_name);
     if (mixin_it == mixin.end()) {
         return;
     }
-
     const auto& mixin_any = mixin_it->second;
     if (!mixin_any.is<toml::Array>()) {
         fatal("`sources-mixins` entry `", mixin_name, "` property `", property_name, "` should be a TOML array");
     }
+    std::size_t i = 0;
     for (auto&& item_any : mixin_any.as<toml::Array>()) {
-        current_array.push(item_any);
+        if (!item_any.is<std::string>()) {
+            fatal("`sources-mixins` entry `", mixin_name, "` array `", property_name, "` item #", i,
+                " is not a TOML string");
+        }
+        results.push_back(item_any.as<std::string>());
+        i++;
     }
 }
 
-static void apply_mixin(
-    const std::string& source_name, const std::string& mixin_name, toml::Table& table, const toml::Table& mixin)
-{
-    if (verbosity >= LogLevel::DIAGNOSTIC) {
-        std::cerr << "`sources-mixins` entry `" << mixin_name << "` is being applied to `sources` entry `"
-                  << source_name << '`' << std::endl;
-    }
-
-    merge_array_property(table, mixin, source_name, mixin_name, "arguments-prepend");
-    merge_array_property(table, mixin, source_name, mixin_name, "arguments-append");
-}
-
-static void apply_mixins(const toml::Value& mixins_any, const std::string& source_name, toml::Table& entry)
+/**
+ * Validate `sources-mixins` and compile the patterns of their `sources` once, rather than for
+ * every `sources` entry they are checked against.
+ */
+[[nodiscard]] static std::vector<SourceMixin> read_mixins(const toml::Value& mixins_any)
 {
     if (!mixins_any.is<toml::Table>()) {
         fatal("`sources-mixins` should be a TOML table");
     }
+    std::vector<SourceMixin> mixins;
     for (auto&& [mixin_name, mixin_any] : mixins_any.as<toml::Table>()) {
         if (!mixin_any.is<toml::Table>()) {
             fatal("`sources-mixins` entry `", mixin_name, "` is not a TOML table");
@@ -130,50 +99,263 @@ static void apply_mixins(const toml::Value& mixins_any, const std::string& sourc
         if (!mixin_sources_any.is<toml::Array>()) {
             fatal("`sources-mixins` entry `", mixin_name, "` must have TOML array `sources`");
         }
-        if (is_mixin_applicable(source_name, mixin_name, mixin_sources_any.as<toml::Array>())) {
-            apply_mixin(source_name, mixin_name, entry, mixin);
+        auto& result = mixins.emplace_back();
+        result.name_ = mixin_name;
+        std::size_t i = 0;
+        for (auto&& mixin_source_any : mixin_sources_any.as<toml::Array>()) {
+            if (!mixin_source_any.is<std::string>()) {
+                fatal("`sources-mixins` entry `", mixin_name, "` array `sources` item #", i, " is not a TOML string");
+            }
+            const auto& mixin_source_string = mixin_source_any.as<std::string>();
+            try {
+                result.sources_.emplace_back(mixin_source_string, std::regex(mixin_source_string));
+            } catch (const std::regex_error& e) {
+                fatal("`sources-mixins` entry `", mixin_name, "` array `sources` item #", i, " (`",
+                    mixin_source_string, "`) has thrown an error: ", describe_regex_error(e.code()));
+            }
+            i++;
+        }
+        read_mixin_array_property(mixin, mixin_name, "arguments-prepend", result.arguments_prepend_);
+        read_mixin_array_property(mixin, mixin_name, "arguments-append", result.arguments_append_);
+        if (auto skip_it = mixin.find("skip-function-bodies"); skip_it != mixin.end()) {
+            if (!skip_it->second.is<bool>()) {
+                fatal("`sources-mixins` entry `", mixin_name,
+                    "` property `skip-function-bodies` should be a TOML boolean");
+            }
+            result.skip_function_bodies_ = skip_it->second.as<bool>();
         }
     }
+    return mixins;
 }
 
-static void parse_sources(const toml::Table& options, const std::string& source_name, ClangSession& session)
+[[nodiscard]] static bool is_mixin_applicable(const std::string& source_name, const SourceMixin& mixin)
 {
+    if (verbosity >= LogLevel::DIAGNOSTIC) {
+        std::cerr << "`sources-mixins` entry `" << mixin.name_
+                  << "` is being being checked for applicability to `sources` entry `" << source_name << '`'
+                  << std::endl;
+    }
+
+    std::size_t i = 0;
+    for (const auto& [mixin_source_string, mixin_source_regex] : mixin.sources_) {
+        const auto regex_match = std::regex_match(source_name.begin(), source_name.end(), mixin_source_regex);
+        if (verbosity >= LogLevel::DEBUG) {
+            std::cerr << "`sources-mixins` entry `" << mixin.name_ << "` array `sources` item #" << i << " (`"
+                      << mixin_source_string << "`) does" << (regex_match ? "" : " NOT") << " match source `"
+                      << source_name << '`' << std::endl;
+        }
+        if (regex_match) {
+            return true;
+        }
+        i++;
+    }
+    return false;
+}
+
+[[nodiscard]] static bool module_flag(const toml::Table& modules, const std::string& property_name, bool default_value)
+{
+    auto property_it = modules.find(property_name);
+    if (property_it == modules.end()) {
+        return default_value;
+    }
+    if (!property_it->second.is<bool>()) {
+        fatal("`modules` property `", property_name, "` should be a TOML boolean");
+    }
+    return property_it->second.as<bool>();
+}
+
+/** Add `option` followed by every string of the `modules` array property, made absolute if `paths` */
+static void add_module_options(const toml::Table& modules, const std::string& property_name, const std::string& option,
+    bool paths, std::vector<std::string>& arguments)
+{
+    auto property_it = modules.find(property_name);
+    if (property_it == modules.end()) {
+        return;
+    }
+    if (!property_it->second.is<toml::Array>()) {
+        fatal("`modules` property `", property_name, "` should be a TOML array");
+    }
+    std::size_t i = 0;
+    for (auto&& item_any : property_it->second.as<toml::Array>()) {
+        if (!item_any.is<std::string>()) {
+            fatal("`modules` array `", property_name, "` item #", i, " is not a TOML string");
+        }
+        const auto& item = item_any.as<std::string>();
+        arguments.push_back(option + (paths ? std::filesystem::absolute(item).u8string() : item));
+        i++;
+    }
+}
+
+/**
+ * The Clang arguments of the `[modules]` table, added to the arguments of every source.  The
+ * paths are made absolute, so that the requests of `--serve` from different directories that use
+ * the same module cache share the parsed sources.
+ */
+[[nodiscard]] static std::vector<std::string> module_arguments()
+{
+    std::vector<std::string> arguments;
+    const auto* modules_any = Config::find("modules");
+    if (!modules_any) {
+        return arguments;
+    }
+    if (!modules_any->is<toml::Table>()) {
+        fatal("`modules` should be a TOML table");
+    }
+    const auto& modules = modules_any->as<toml::Table>();
+    if (!module_flag(modules, "enabled", true)) {
+        return arguments;
+    }
+
+    arguments.emplace_back("-fmodules");
+    if (auto cache_path_it = modules.find("cache-path"); cache_path_it != modules.end()) {
+        if (!cache_path_it->second.is<std::string>()) {
+            fatal("`modules` property `cache-path` should be a TOML string");
+        }
+        arguments.push_back(
+            "-fmodules-cache-path=" + std::filesystem::absolute(cache_path_it->second.as<std::string>()).u8string());
+    }
+    if (!module_flag(modules, "implicit-modules", true)) {
+        arguments.emplace_back("-fno-implicit-modules");
+    }
+    if (!module_flag(modules, "implicit-module-maps", true)) {
+        arguments.emplace_back("-fno-implicit-module-maps");
+    }
+    if (module_flag(modules, "validate-input-files-content", false)) {
+        // The module cache stays valid when the headers are checked out anew with other
+        // modification times, like in CI jobs restoring the cache
+        arguments.emplace_back("-fvalidate-ast-input-files-content");
+    }
+    add_module_options(modules, "module-maps", "-fmodule-map-file=", true, arguments);
+    add_module_options(modules, "prebuilt-module-paths", "-fprebuilt-module-path=", true, arguments);
+    add_module_options(modules, "module-files", "-fmodule-file=", false, arguments);
+
+    if (verbosity >= LogLevel::DEBUG) {
+        std::cerr << "Module arguments:";
+        for (const auto& argument : arguments) {
+            std::cerr << ' ' << argument;
+        }
+        std::cerr << std::endl;
+    }
+    return arguments;
+}
+
+static void collect_sources(const toml::Table& options, const std::string& source_name,
+    const std::vector<std::string>& module_arguments, const std::vector<SourceMixin>& mixins,
+    const std::shared_ptr<const ParsePruning>& pruning, std::vector<SourceUnit>& units)
+{
+    std::vector<const SourceMixin*> applicable_mixins;
+    for (const auto& mixin : mixins) {
+        if (is_mixin_applicable(source_name, mixin)) {
+            if (verbosity >= LogLevel::DIAGNOSTIC) {
+                std::cerr << "`sources-mixins` entry `" << mixin.name_ << "` is being applied to `sources` entry `"
+                          << source_name << '`' << std::endl;
+            }
+            applicable_mixins.push_back(&mixin);
+        }
+    }
+
     std::vector<std::string> files;
     toml_array_to_vector(options, source_name, files, "paths");
 
+    // The arguments of the mixins are appended to the corresponding arguments of the entry
     std::vector<std::string> arguments;
     toml_array_to_vector(options, source_name, arguments, "arguments-prepend");
+    for (const auto* mixin : applicable_mixins) {
+        arguments.insert(arguments.end(), mixin->arguments_prepend_.begin(), mixin->arguments_prepend_.end());
+    }
     toml_array_to_vector(options, source_name, arguments, "arguments");
     toml_array_to_vector(options, source_name, arguments, "arguments-append");
+    for (const auto* mixin : applicable_mixins) {
+        arguments.insert(arguments.end(), mixin->arguments_append_.begin(), mixin->arguments_append_.end());
+    }
+    arguments.insert(arguments.end(), module_arguments.begin(), module_arguments.end());
+
+    auto skip_function_bodies = false;
+    auto skip_it = options.find("skip-function-bodies");
+    if (skip_it != options.end()) {
+        if (!skip_it->second.is<bool>()) {
+            fatal("Source `", source_name, "` property `skip-function-bodies` should be a TOML boolean");
+        }
+        skip_function_bodies = skip_it->second.as<bool>();
+    } else {
+        // The value of the `sources` entry itself takes precedence, then the first mixin having it
+        for (const auto* mixin : applicable_mixins) {
+            if (mixin->skip_function_bodies_) {
+                if (verbosity >= LogLevel::DEBUG) {
+                    std::cerr << "`sources` entry `" << source_name
+                              << "` takes `skip-function-bodies` from `sources-mixins` entry `" << mixin->name_
+                              << '`' << std::endl;
+                }
+                skip_function_bodies = *mixin->skip_function_bodies_;
+                break;
+            }
+        }
+    }
 
-    session.parse_sources(files, arguments);
+    auto all_file_names_are_empty = true;
+    for (auto&& file : files) {
+        if (!file.empty()) {
+            all_file_names_are_empty = false;
+            units.push_back({file, arguments, skip_function_bodies, pruning});
+        }
+    }
+    if (all_file_names_are_empty) {
+        fatal("No input files");
+    }
 }
 
-void parse_sources()
+std::vector<SourceUnit> collect_sources()
 {
     const auto* sources_any = Config::find("sources");
     if (!sources_any || !sources_any->is<toml::Table>()) {
         fatal("`sources` should be a TOML table");
     }
-    auto session_ptr = ClangSession::create();
-    auto& session = *session_ptr;
 
-    const auto* mixins_any = Config::find("sources-mixins");
+    std::vector<SourceUnit> units;
+    auto module_arguments = objcgen::module_arguments();
+    if (current_target) {
+        module_arguments.insert(
+            module_arguments.end(), current_target->arguments_.begin(), current_target->arguments_.end());
+    }
+    const auto pruning = ParsePruning::create();
+    std::vector<SourceMixin> mixins;
+    if (const auto* mixins_any = Config::find("sources-mixins")) {
+        mixins = read_mixins(*mixins_any);
+    }
     for (auto&& [source_name, source_any] : sources_any->as<toml::Table>()) {
         if (!source_any.is<toml::Table>()) {
             fatal("`sources` entry `", source_name, "` is not a TOML table");
         }
-        const auto& source_table = source_any.as<toml::Table>();
-        if (mixins_any) {
-            toml::Table entry = source_table;
-
-            apply_mixins(*mixins_any, source_name, entry);
+        collect_sources(source_any.as<toml::Table>(), source_name, module_arguments, mixins, pruning, units);
+    }
+    return units;
+}
 
-            parse_sources(entry, source_name, session);
-        } else {
-            parse_sources(source_table, source_name, session);
+std::string sources_key(const std::vector<SourceUnit>& units)
+{
+    std::string key;
+    for (const auto& unit : units) {
+        key += unit.skip_function_bodies_ ? "\n-" : "\n+";
+        key += unit.file_;
+        for (const auto& argument : unit.arguments_) {
+            key += '\0';
+            key += argument;
         }
+        key += '\0';
+        key += unit.pruning_key();
     }
+    return key;
+}
+
+void parse_sources(ClangSession& session, const std::vector<SourceUnit>& units)
+{
+    session.parse_sources(units);
+}
+
+void parse_sources()
+{
+    auto units = collect_sources();
+    parse_sources(*ClangSession::create(), units);
 }
 
 } // namespace objcgen
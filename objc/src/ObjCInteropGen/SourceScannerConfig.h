@@ -8,8 +8,45 @@
 #ifndef SOURCESCANNERCONFIG_H
 #define SOURCESCANNERCONFIG_H
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ParsePruning.h"
+
 namespace objcgen {
 
+class ClangSession;
+
+/** A source file and the Clang arguments to parse it with */
+struct SourceUnit {
+    std::string file_;
+    std::vector<std::string> arguments_;
+    /** Whether the bodies of the functions and methods are skipped while parsing */
+    bool skip_function_bodies_ = false;
+    /** The symbols to build while parsing, if `[parse-pruning]` is enabled */
+    std::shared_ptr<const ParsePruning> pruning_;
+
+    [[nodiscard]] bool operator==(const SourceUnit& other) const
+    {
+        return file_ == other.file_ && arguments_ == other.arguments_ &&
+            skip_function_bodies_ == other.skip_function_bodies_ && pruning_key() == other.pruning_key();
+    }
+
+    [[nodiscard]] std::string pruning_key() const
+    {
+        return pruning_ ? 'P' + pruning_->key() : std::string();
+    }
+};
+
+/** The sources of the current configuration in the parse order, with `sources-mixins` applied */
+[[nodiscard]] std::vector<SourceUnit> collect_sources();
+
+/** The string that is equal for the units parsed the same way */
+[[nodiscard]] std::string sources_key(const std::vector<SourceUnit>& units);
+
+void parse_sources(ClangSession& session, const std::vector<SourceUnit>& units);
+
 void parse_sources();
 
 } // namespace objcgen
@@ -0,0 +1,299 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Stats.h"
+
+#include <array>
+#include <iomanip>
+#include <ostream>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "CangjieWriter.h"
+#include "InputFile.h"
+#include "JsonWriter.h"
+#include "Package.h"
+#include "Universe.h"
+
+namespace objcgen {
+
+struct StageRecord {
+    std::string name_;
+    double wall_ms_;
+    double cpu_ms_;
+};
+
+static std::vector<StageRecord> stages;
+
+/** CPU time (user + system) consumed by the process, in milliseconds */
+[[nodiscard]] static double cpu_time_ms() noexcept
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    auto to_100ns = [](const FILETIME& time) {
+        return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return static_cast<double>(to_100ns(kernel) + to_100ns(user)) / 1e4;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    auto to_ms = [](const timeval& time) {
+        return static_cast<double>(time.tv_sec) * 1e3 + static_cast<double>(time.tv_usec) / 1e3;
+    };
+    return to_ms(usage.ru_utime) + to_ms(usage.ru_stime);
+#endif
+}
+
+/** Peak resident set size of the process in bytes, or 0 if it is unknown */
+[[nodiscard]] static std::uint64_t peak_rss() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+StageTimer::StageTimer(std::string name)
+    : name_(std::move(name)), wall_start_(std::chrono::steady_clock::now()), cpu_start_(cpu_time_ms())
+{
+}
+
+StageTimer::~StageTimer()
+{
+    auto wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start_).count();
+    stages.push_back({std::move(name_), wall_ms, cpu_time_ms() - cpu_start_});
+}
+
+constexpr std::array TYPE_KIND_NAMES = {
+    "Unexposed", "Primitive", "BuiltIn", "TypeDef", "Protocol", "Interface", "Struct", "Union", "Enum", "Category",
+    "TopLevel"};
+
+static_assert(TYPE_KIND_NAMES.size() == static_cast<std::size_t>(NamedTypeSymbol::Kind::TopLevel) + 1);
+
+constexpr std::array MEMBER_KIND_NAMES = {
+    "Field", "Property", "InstanceVariable", "GlobalFunction", "MemberMethod", "Constructor"};
+
+static_assert(MEMBER_KIND_NAMES.size() == static_cast<std::size_t>(NonTypeSymbol::Kind::Constructor) + 1);
+
+/** The message sends written for a package and the number of their distinct C signatures */
+struct PackageSends {
+    std::string_view package_;
+    std::uint64_t sends_;
+    std::uint64_t signatures_;
+};
+
+struct Counts {
+    std::uint64_t input_files_ = 0;
+    std::array<std::uint64_t, TYPE_KIND_NAMES.size()> types_{};
+    std::array<std::uint64_t, MEMBER_KIND_NAMES.size()> members_{};
+    std::uint64_t reference_edges_ = 0;
+    /** Results with `ns_returns_retained` or `ns_returns_not_retained` overriding the method family */
+    std::uint64_t ownership_attributed_results_ = 0;
+    std::uint64_t inner_pointer_results_ = 0;
+    std::uint64_t consumed_parameters_ = 0;
+    std::uint64_t package_files_ = 0;
+    std::uint64_t bytes_written_ = 0;
+    std::uint64_t message_sends_ = 0;
+    /** The distinct C signatures of all the packages, each counted once */
+    std::uint64_t send_signatures_ = 0;
+    std::vector<PackageSends> package_sends_;
+};
+
+static void count_ownership(Counts& counts, const NonTypeSymbol& member)
+{
+    counts.ownership_attributed_results_ += member.is_ownership_attributed();
+    counts.inner_pointer_results_ += member.returns_inner_pointer();
+    for (const auto& parameter : member.parameters()) {
+        counts.consumed_parameters_ += parameter.is_consumed();
+    }
+}
+
+[[nodiscard]] static Counts count_symbols()
+{
+    Counts counts;
+    for (const auto& input_file : inputs) {
+        ++counts.input_files_;
+        for (const auto& symbol : input_file) {
+            counts.reference_edges_ += symbol.references_symbols().size();
+        }
+    }
+
+    const auto& universe = Universe::get();
+    for (const auto& type : universe.types()) {
+        ++counts.types_[static_cast<std::size_t>(type.kind())];
+        if (const auto* decl = dynamic_cast<const TypeDeclarationSymbol*>(&type)) {
+            for (const auto& member : decl->members()) {
+                ++counts.members_[static_cast<std::size_t>(member.kind())];
+                count_ownership(counts, member);
+            }
+        }
+    }
+    counts.members_[static_cast<std::size_t>(NonTypeSymbol::Kind::GlobalFunction)] += universe.top_level().size();
+
+    std::unordered_set<std::string_view> signatures;
+    for (auto&& package : packages) {
+        for (auto&& package_file : package) {
+            ++counts.package_files_;
+            counts.bytes_written_ += package_file.size();
+        }
+        if (const auto* package_signatures = send_signatures(package)) {
+            counts.message_sends_ += package_signatures->sends_;
+            counts.package_sends_.push_back(
+                {package.cangjie_name(), package_signatures->sends_, package_signatures->signatures_.size()});
+            signatures.insert(package_signatures->signatures_.begin(), package_signatures->signatures_.end());
+        }
+    }
+    counts.send_signatures_ = signatures.size();
+    return counts;
+}
+
+template <std::size_t N>
+static void print_kinds(std::ostream& output, const char* title, const std::array<const char*, N>& names,
+    const std::array<std::uint64_t, N>& counts)
+{
+    std::uint64_t total = 0;
+    for (auto count : counts) {
+        total += count;
+    }
+    output << title << total << std::endl;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (counts[i] != 0) {
+            output << "    " << std::left << std::setw(20) << names[i] << counts[i] << std::endl;
+        }
+    }
+}
+
+static void print_text(std::ostream& output, const Counts& counts)
+{
+    output << "Stages (wall / CPU time, ms):" << std::endl;
+    auto flags = output.flags();
+    auto precision = output.precision(1);
+    output << std::fixed;
+    double wall_total = 0;
+    double cpu_total = 0;
+    for (const auto& stage : stages) {
+        output << "    " << std::left << std::setw(40) << stage.name_ << std::right << std::setw(10) << stage.wall_ms_
+               << " / " << std::setw(10) << stage.cpu_ms_ << std::endl;
+        wall_total += stage.wall_ms_;
+        cpu_total += stage.cpu_ms_;
+    }
+    output << "    " << std::left << std::setw(40) << "Total" << std::right << std::setw(10) << wall_total << " / "
+           << std::setw(10) << cpu_total << std::endl;
+    output.flags(flags);
+    output.precision(precision);
+
+    output << "Peak RSS: " << peak_rss() / 1024 << " KiB" << std::endl;
+    output << "Input files: " << counts.input_files_ << std::endl;
+    print_kinds(output, "Types: ", TYPE_KIND_NAMES, counts.types_);
+    print_kinds(output, "Members: ", MEMBER_KIND_NAMES, counts.members_);
+    output << "Reference edges: " << counts.reference_edges_ << std::endl;
+    output << "Ownership-attributed results: " << counts.ownership_attributed_results_ << std::endl;
+    output << "Inner pointer results: " << counts.inner_pointer_results_ << std::endl;
+    output << "Consumed parameters: " << counts.consumed_parameters_ << std::endl;
+    output << "Package files: " << counts.package_files_ << std::endl;
+    output << "Bytes written: " << counts.bytes_written_ << std::endl;
+    output << "Message sends: " << counts.message_sends_ << " with " << counts.send_signatures_
+           << " distinct C signatures" << std::endl;
+    for (const auto& package : counts.package_sends_) {
+        output << "    " << std::left << std::setw(40) << package.package_ << package.sends_ << " with "
+               << package.signatures_ << std::endl;
+    }
+    output.flags(flags);
+}
+
+template <std::size_t N>
+static void write_kinds(
+    JsonWriter& json, const std::array<const char*, N>& names, const std::array<std::uint64_t, N>& counts)
+{
+    json.begin_object();
+    for (std::size_t i = 0; i < N; ++i) {
+        json.key(names[i]).number(counts[i]);
+    }
+    json.end_object();
+}
+
+static void print_json(std::ostream& output, const Counts& counts)
+{
+    JsonWriter json(output);
+    json.begin_object();
+    json.key("stages").begin_array();
+    for (const auto& stage : stages) {
+        json.begin_object();
+        json.key("name").string(stage.name_);
+        json.key("wall_ms").number(stage.wall_ms_);
+        json.key("cpu_ms").number(stage.cpu_ms_);
+        json.end_object();
+    }
+    json.end_array();
+    json.key("peak_rss").number(peak_rss());
+    json.key("input_files").number(counts.input_files_);
+    json.key("types");
+    write_kinds(json, TYPE_KIND_NAMES, counts.types_);
+    json.key("members");
+    write_kinds(json, MEMBER_KIND_NAMES, counts.members_);
+    json.key("reference_edges").number(counts.reference_edges_);
+    json.key("ownership").begin_object();
+    json.key("attributed_results").number(counts.ownership_attributed_results_);
+    json.key("inner_pointer_results").number(counts.inner_pointer_results_);
+    json.key("consumed_parameters").number(counts.consumed_parameters_);
+    json.end_object();
+    json.key("package_files").number(counts.package_files_);
+    json.key("bytes_written").number(counts.bytes_written_);
+    json.key("message_sends").begin_object();
+    json.key("sends").number(counts.message_sends_);
+    json.key("distinct_signatures").number(counts.send_signatures_);
+    json.key("packages").begin_object();
+    for (const auto& package : counts.package_sends_) {
+        json.key(package.package_).begin_object();
+        json.key("sends").number(package.sends_);
+        json.key("distinct_signatures").number(package.signatures_);
+        json.end_object();
+    }
+    json.end_object();
+    json.end_object();
+    json.end_object();
+}
+
+void print_stats(std::ostream& output, StatsFormat format)
+{
+    auto counts = count_symbols();
+    switch (format) {
+        case StatsFormat::TEXT:
+            print_text(output, counts);
+            break;
+        case StatsFormat::JSON:
+            print_json(output, counts);
+            break;
+    }
+}
+
+} // namespace objcgen
@@ -0,0 +1,44 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+namespace objcgen {
+
+enum class StatsFormat { TEXT, JSON };
+
+/** Measures the wall and CPU time of a generator stage for the statistics report */
+class StageTimer final {
+public:
+    explicit StageTimer(std::string name);
+
+    StageTimer(const StageTimer&) = delete;
+
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    ~StageTimer();
+
+private:
+    std::string name_;
+    std::chrono::steady_clock::time_point wall_start_;
+    double cpu_start_;
+};
+
+/**
+ * Print the statistics report: the time of the stages measured by `StageTimer`, the peak memory
+ * usage and the sizes of the symbol tables and of the outputs.
+ */
+void print_stats(std::ostream& output, StatsFormat format);
+
+} // namespace objcgen
+
+#endif // STATS_H
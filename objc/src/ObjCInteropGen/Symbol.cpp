@@ -6,6 +6,7 @@
 
 #include "Symbol.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "Logging.h"
@@ -171,17 +172,16 @@ void FileLevelSymbol::register_for_package(Package& package)
     output_file_ = file ? file : &package.add_file(file_name);
 }
 
-[[nodiscard]] static bool referencing_packages_detailed_info() noexcept
+void FileLevelSymbol::move_to_package(Package& package)
 {
-    return verbosity > LogLevel::WARNING;
+    assert(output_file_);
+    output_file_ = nullptr;
+    register_for_package(package);
 }
 
 void FileLevelSymbol::add_referencing_package(const Package& package)
 {
-    ++number_of_referencing_packages_;
-    if (referencing_packages_detailed_info()) {
-        referencing_packages_.insert(&package);
-    }
+    referencing_packages_.insert(&package);
 }
 
 Package* FileLevelSymbol::package() const noexcept
@@ -190,14 +190,9 @@ Package* FileLevelSymbol::package() const noexcept
     return file ? &file->package() : nullptr;
 }
 
-size_t FileLevelSymbol::number_of_referencing_packages() const noexcept
-{
-    return referencing_packages_detailed_info() ? referencing_packages_.size() : number_of_referencing_packages_;
-}
-
 void FileLevelSymbol::print_referencing_packages_info() const
 {
-    if (referencing_packages_detailed_info()) {
+    if (verbosity > LogLevel::WARNING) {
         std::cerr << ":\n";
         for (const auto* package : referencing_packages_) {
             std::cerr << "* " << package->cangjie_name() << std::endl;
@@ -689,7 +684,6 @@ void NamedTypeSymbol::set_mapping(const TypeMapping& mapping) noexcept
 TypeLikeSymbol& NamedTypeSymbol::map()
 {
     if (auto* mapping = this->mapping()) {
-        assert(mapping->can_map(*this));
         return mapping->map();
     }
     return *this;
@@ -824,13 +818,18 @@ void TypeDeclarationSymbol::member_remove(size_t index)
         case Kind::Struct:
         case Kind::Union: {
             assert(it->kind() == NonTypeSymbol::Kind::Field);
+            // Only removing a non-C field or a field with pointers can change the flags, so the
+            // other removals do not scan the rest of the fields
             auto removing_ctype = it->return_type().is_ctype();
+            auto removing_pointer_or_func = it->return_type().contains_pointer_or_func();
             members_.erase(it);
             if (!removing_ctype) {
                 is_ctype_ = all_of_members([](const auto& member) { return member.return_type().is_ctype(); });
             }
-            contains_pointer_or_func_ =
-                any_of_members([](const auto& member) { return member.return_type().contains_pointer_or_func(); });
+            if (removing_pointer_or_func) {
+                contains_pointer_or_func_ =
+                    any_of_members([](const auto& member) { return member.return_type().contains_pointer_or_func(); });
+            }
             break;
         }
         default:
@@ -927,6 +926,15 @@ void TypeDeclarationSymbol::mark_transformed() noexcept
     transformed_ = true;
 }
 
+void TypeDeclarationSymbol::restore_members(
+    std::vector<NonTypeSymbol> members, bool is_ctype, bool contains_pointer_or_func) noexcept
+{
+    assert(members_.empty());
+    members_ = std::move(members);
+    is_ctype_ = is_ctype;
+    contains_pointer_or_func_ = contains_pointer_or_func;
+}
+
 bool TypeDeclarationSymbol::visit_referenced_types(const FileLevelSymbolVisitor& visitor)
 {
     // It could make sense to analyze if infinite recursion is possible here.  With
@@ -1166,6 +1174,17 @@ const NonTypeSymbol* NonTypeSymbol::find_getter(const TypeDeclarationSymbol& dec
 }
 
 ClosureDepthType NonTypeSymbol::calculate_reference_level(const TypeDeclarationSymbol& decl) const noexcept
+{
+    if (!types_frozen()) {
+        return compute_reference_level(decl);
+    }
+    if (!member_reference_level_) {
+        member_reference_level_ = compute_reference_level(decl);
+    }
+    return *member_reference_level_;
+}
+
+ClosureDepthType NonTypeSymbol::compute_reference_level(const TypeDeclarationSymbol& decl) const noexcept
 {
     switch (kind_) {
         case Kind::Field:
@@ -1194,4 +1213,87 @@ ClosureDepthType NonTypeSymbol::calculate_reference_level(const TypeDeclarationS
     }
 }
 
+static bool frozen_types = false;
+
+void freeze_types() noexcept
+{
+    frozen_types = true;
+}
+
+bool types_frozen() noexcept
+{
+    return frozen_types;
+}
+
+Type TypeAliasSymbol::canonical_type() const
+{
+    return frozen_types ? frozen_canonical_type() : target_.canonical_type();
+}
+
+const Type& TypeAliasSymbol::frozen_canonical_type() const
+{
+    assert(frozen_types);
+    if (!canonical_type_) {
+        canonical_type_ = target_.canonical_type();
+    }
+    return *canonical_type_;
+}
+
+/**
+ * The type with the type alias expanded.  Before `freeze_types`, the expanded type is stored to
+ * `storage`, otherwise it is not copied.
+ */
+[[nodiscard]] static const Type& expand_alias(const Type& type, Type& storage)
+{
+    const auto* alias = dynamic_cast<const TypeAliasSymbol*>(&type.symbol());
+    if (!alias) {
+        return type;
+    }
+    if (frozen_types) {
+        return alias->frozen_canonical_type();
+    }
+    storage = alias->canonical_type();
+    return storage;
+}
+
+bool same_types(const Type& type1, const Type& type2) noexcept
+{
+    Type storage1;
+    Type storage2;
+    const auto& t1 = expand_alias(type1, storage1);
+    const auto& t2 = expand_alias(type2, storage2);
+    const auto* symbol1 = &t1.symbol();
+    const auto* symbol2 = &t2.symbol();
+
+    if (t1.is_cj_direct_option() != t2.is_cj_direct_option()) {
+        return false;
+    }
+
+    switch (t1.kind()) {
+        case Type::Kind::Pointer:
+            if (t2.kind() != Type::Kind::Pointer) {
+                return false;
+            }
+            assert(t1.parameters().size() == 1);
+            assert(t2.parameters().size() == 1);
+            return same_types(*t1.parameters().begin(), *t2.parameters().begin());
+        case Type::Kind::Function: {
+            if (t2.kind() != Type::Kind::Function) {
+                return false;
+            }
+            const auto& parameters1 = t1.parameters();
+            const auto& parameters2 = t2.parameters();
+            return std::equal(parameters1.begin(), parameters1.end(), parameters2.begin(), parameters2.end(),
+                [](const auto& param1, const auto& param2) { return same_types(param1, param2); });
+        }
+        case Type::Kind::VArray:
+            return t2.kind() == Type::Kind::VArray && t1.varray_size() == t2.varray_size() &&
+                same_types(t1.varray_element_type(), t2.varray_element_type());
+        case Type::Kind::TypeParam:
+            return t2.kind() == Type::Kind::TypeParam && &t1.actual_protocol() == &t2.actual_protocol();
+        default:
+            return symbol1 == symbol2;
+    }
+}
+
 } // namespace objcgen
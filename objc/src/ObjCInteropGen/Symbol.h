@@ -10,6 +10,7 @@
 
 #include <array>
 #include <functional>
+#include <optional>
 
 #include "Config.h"
 #include "InputFile.h"
@@ -160,6 +161,11 @@ public:
         return input_file_;
     }
 
+    [[nodiscard]] const LineCol& location() const noexcept
+    {
+        return location_;
+    }
+
     [[nodiscard]] PackageFile* package_file() const noexcept
     {
         return output_file_;
@@ -167,6 +173,9 @@ public:
 
     void register_for_package(Package& package);
 
+    /** Register for `package` instead of the package the symbol is currently registered for */
+    void move_to_package(Package& package);
+
     void add_referencing_package(const Package& package);
 
     [[nodiscard]] Package* package() const noexcept;
@@ -186,7 +195,15 @@ public:
         return reference_level_;
     }
 
-    [[nodiscard]] size_t number_of_referencing_packages() const noexcept;
+    [[nodiscard]] const std::unordered_set<const Package*>& referencing_packages() const noexcept
+    {
+        return referencing_packages_;
+    }
+
+    [[nodiscard]] size_t number_of_referencing_packages() const noexcept
+    {
+        return referencing_packages_.size();
+    }
 
     void print_referencing_packages_info() const;
 
@@ -232,9 +249,7 @@ private:
 
     OutputStatus output_status_ = OutputStatus::Undefined;
 
-    size_t number_of_referencing_packages_ = 0;
-
-    // Used only for debug print when verbosity > LogLevel::WARNING
+    // The packages referencing the symbol that is not a root
     std::unordered_set<const Package*> referencing_packages_;
 };
 
@@ -658,6 +673,16 @@ constexpr Modifiers ModifierBitField = 1 << 8;
 // example, getter method sharing the same name with its property.
 constexpr Modifiers ModifierHidden = 1 << 9;
 
+// The ownership of the object returned by a method.  `ModifierReturnsRetained` is set if the
+// result is +1, either by the alloc/copy/init/mutableCopy/new method family or by the
+// `ns_returns_retained` attribute.  `ModifierOwnershipAttributed` is set if an attribute
+// (`ns_returns_retained` or `ns_returns_not_retained`) overrides the method family.
+constexpr Modifiers ModifierReturnsRetained = 1 << 11;
+constexpr Modifiers ModifierOwnershipAttributed = 1 << 12;
+
+// `objc_returns_inner_pointer`: the result is valid only while the receiver is alive
+constexpr Modifiers ModifierReturnsInnerPointer = 1 << 13;
+
 /**
  * A type parameter, when using inside a generic body, can be constrainted by
  * specific protocols.  Like here in the parameter `x`:
@@ -712,8 +737,20 @@ public:
         type_ = std::move(type);
     }
 
+    /** Whether the parameter has the `ns_consumed` attribute, so the callee releases it */
+    [[nodiscard]] bool is_consumed() const noexcept
+    {
+        return consumed_;
+    }
+
+    void set_consumed() noexcept
+    {
+        consumed_ = true;
+    }
+
 private:
     Type type_;
+    bool consumed_ = false;
 };
 
 class TypeDeclarationSymbol : public NamedTypeSymbol {
@@ -807,6 +844,12 @@ public:
 
     void mark_transformed() noexcept;
 
+    /**
+     * Set the members loaded from a universe snapshot, along with the flags derived from them
+     * when the members were added one by one.
+     */
+    void restore_members(std::vector<NonTypeSymbol> members, bool is_ctype, bool contains_pointer_or_func) noexcept;
+
 private:
     bool visit_referenced_types(const FileLevelSymbolVisitor& visitor) override;
 
@@ -869,10 +912,10 @@ public:
      * the canonical type for Alias will be T, and the canonical type for Alias2
      * will be Option<T>.
      */
-    [[nodiscard]] Type canonical_type() const
-    {
-        return target_.canonical_type();
-    }
+    [[nodiscard]] Type canonical_type() const;
+
+    /** The same as `canonical_type`, without copying.  Only after `freeze_types`. */
+    [[nodiscard]] const Type& frozen_canonical_type() const;
 
 private:
     [[nodiscard]] bool is_ctype() const noexcept override
@@ -890,6 +933,7 @@ private:
     }
 
     Type target_;
+    mutable std::optional<Type> canonical_type_;
 };
 
 class NonTypeSymbol final : public FileLevelSymbol {
@@ -919,6 +963,11 @@ public:
         return kind_;
     }
 
+    [[nodiscard]] Modifiers modifiers() const noexcept
+    {
+        return modifiers_;
+    }
+
     // String value for the @ForeignName attribute.  If empty, no value is specified
     // for @ForeignName.
     [[nodiscard]] const std::string& selector_attribute() const noexcept
@@ -1075,11 +1124,28 @@ public:
         modifiers_ |= ModifierHidden;
     }
 
+    [[nodiscard]] bool returns_retained() const noexcept
+    {
+        return modifiers_ & ModifierReturnsRetained;
+    }
+
+    [[nodiscard]] bool is_ownership_attributed() const noexcept
+    {
+        return modifiers_ & ModifierOwnershipAttributed;
+    }
+
+    [[nodiscard]] bool returns_inner_pointer() const noexcept
+    {
+        return modifiers_ & ModifierReturnsInnerPointer;
+    }
+
     [[nodiscard]] ClosureDepthType calculate_reference_level(const TypeDeclarationSymbol& decl) const noexcept;
 
 private:
     bool visit_referenced_types(const FileLevelSymbolVisitor& visitor) override;
 
+    [[nodiscard]] ClosureDepthType compute_reference_level(const TypeDeclarationSymbol& decl) const noexcept;
+
     Kind kind_;
     Modifiers modifiers_;
 
@@ -1095,8 +1161,26 @@ private:
     Type return_type_;
     std::vector<ParameterSymbol> parameters_;
     std::string selector_attribute_;
+
+    // Computed by `calculate_reference_level` once the types are frozen
+    mutable std::optional<ClosureDepthType> member_reference_level_;
 };
 
+/**
+ * Return true if the types are the same after expanding the type aliases, that is, if they are
+ * indistinguishable in the Cangjie overload resolution.
+ */
+[[nodiscard]] bool same_types(const Type& type1, const Type& type2) noexcept;
+
+/**
+ * Called after the transforms and the mappings, when the types and the reference levels do not
+ * change anymore.  Since then, the canonical types of the type aliases and the reference levels
+ * of the members are computed once and cached.
+ */
+void freeze_types() noexcept;
+
+[[nodiscard]] bool types_frozen() noexcept;
+
 template <class T> class Printer {
 public:
     Printer(const T& obj, PrintFormat format) noexcept : obj_(obj), format_(format)
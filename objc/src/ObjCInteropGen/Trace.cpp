@@ -0,0 +1,149 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "JsonWriter.h"
+
+namespace objcgen {
+
+struct TraceArg {
+    std::string name_;
+    std::uint64_t number_;
+    std::string string_;
+    bool is_string_;
+};
+
+struct TraceEventRecord {
+    std::string name_;
+    std::string category_;
+    double start_;
+    double duration_ = -1;
+    std::vector<TraceArg> args_;
+};
+
+static bool tracing = false;
+static std::chrono::steady_clock::time_point trace_start;
+static std::vector<TraceEventRecord> events;
+
+/** Microseconds since the trace start, which is the time unit of the trace event format */
+[[nodiscard]] static double now() noexcept
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - trace_start).count();
+}
+
+TraceEvent::TraceEvent(std::string name, std::string_view category)
+{
+    if (tracing) {
+        index_ = events.size();
+        events.push_back({std::move(name), std::string(category), now(), -1, {}});
+    }
+}
+
+TraceEvent& TraceEvent::arg(std::string_view name, std::uint64_t value)
+{
+    if (index_ != NO_EVENT) {
+        events[index_].args_.push_back({std::string(name), value, {}, false});
+    }
+    return *this;
+}
+
+TraceEvent& TraceEvent::arg(std::string_view name, std::string_view value)
+{
+    if (index_ != NO_EVENT) {
+        events[index_].args_.push_back({std::string(name), 0, std::string(value), true});
+    }
+    return *this;
+}
+
+void TraceEvent::end() noexcept
+{
+    if (index_ != NO_EVENT) {
+        auto& event = events[index_];
+        event.duration_ = now() - event.start_;
+        index_ = NO_EVENT;
+    }
+}
+
+void TraceSession::start(std::filesystem::path output_path)
+{
+    output_path_ = std::move(output_path);
+    if (!tracing) {
+        tracing = true;
+        trace_start = std::chrono::steady_clock::now();
+    }
+}
+
+static void write_trace(std::ostream& output)
+{
+    JsonWriter json(output);
+    json.begin_object();
+    json.key("displayTimeUnit").string("ms");
+    json.key("traceEvents").begin_array();
+
+    json.begin_object();
+    json.key("name").string("process_name");
+    json.key("ph").string("M");
+    json.key("pid").number(1);
+    json.key("tid").number(1);
+    json.key("args").begin_object().key("name").string("ObjCInteropGen").end_object();
+    json.end_object();
+
+    auto end = now();
+    for (const auto& event : events) {
+        json.begin_object();
+        json.key("name").string(event.name_);
+        json.key("cat").string(event.category_);
+        json.key("ph").string("X");
+        json.key("pid").number(1);
+        json.key("tid").number(1);
+        json.key("ts").number(event.start_);
+        // Events not ended yet (if the generator has failed) last till the end of the trace
+        json.key("dur").number(event.duration_ < 0 ? end - event.start_ : event.duration_);
+        if (!event.args_.empty()) {
+            json.key("args").begin_object();
+            for (const auto& arg : event.args_) {
+                json.key(arg.name_);
+                if (arg.is_string_) {
+                    json.string(arg.string_);
+                } else {
+                    json.number(arg.number_);
+                }
+            }
+            json.end_object();
+        }
+        json.end_object();
+    }
+
+    json.end_array();
+    json.end_object();
+}
+
+TraceSession::~TraceSession()
+{
+    if (!tracing) {
+        return;
+    }
+    tracing = false;
+    try {
+        std::ofstream output(output_path_);
+        if (output) {
+            write_trace(output);
+        }
+        if (!output) {
+            std::cerr << "Cannot write trace file `" << output_path_.u8string() << '`' << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot write trace file `" << output_path_.u8string() << "`: " << e.what() << std::endl;
+    }
+}
+
+} // namespace objcgen
@@ -0,0 +1,73 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace objcgen {
+
+/**
+ * A complete ("X" phase) event of the Chrome trace event format, which can be viewed with
+ * chrome://tracing or Perfetto.  The event covers the time from the construction till the
+ * destruction (or the `end()` call).  Nothing is recorded unless tracing is enabled.
+ */
+class TraceEvent final {
+public:
+    explicit TraceEvent(std::string name, std::string_view category = "stage");
+
+    TraceEvent(const TraceEvent&) = delete;
+
+    TraceEvent& operator=(const TraceEvent&) = delete;
+
+    ~TraceEvent()
+    {
+        end();
+    }
+
+    TraceEvent& arg(std::string_view name, std::uint64_t value);
+
+    TraceEvent& arg(std::string_view name, std::string_view value);
+
+    void end() noexcept;
+
+private:
+    static constexpr std::size_t NO_EVENT = std::numeric_limits<std::size_t>::max();
+
+    std::size_t index_ = NO_EVENT;
+};
+
+/**
+ * Enables tracing for its lifetime and writes the recorded events to the output file on
+ * destruction.  It is intended to be created at the beginning of `main`, so that the trace is
+ * written even if the generator fails.  A session started while another one is active writes the
+ * events recorded by both.
+ */
+class TraceSession final {
+public:
+    TraceSession() = default;
+
+    TraceSession(const TraceSession&) = delete;
+
+    TraceSession& operator=(const TraceSession&) = delete;
+
+    ~TraceSession();
+
+    void start(std::filesystem::path output_path);
+
+private:
+    std::filesystem::path output_path_;
+};
+
+} // namespace objcgen
+
+#endif // TRACE_H
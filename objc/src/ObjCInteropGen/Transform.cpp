@@ -10,6 +10,7 @@
 
 #include "Logging.h"
 #include "Mappings.h"
+#include "Trace.h"
 #include "Universe.h"
 
 namespace objcgen {
@@ -613,6 +614,7 @@ static void transform_visit(TypeDeclarationSymbol& decl)
  */
 static void transform_visit()
 {
+    TraceEvent event("transform_visit", "apply_transforms");
     auto& universe = Universe::get();
 
     // In standalone functions, all parameter names are unique, but some of the
@@ -636,15 +638,18 @@ static void transform_visit()
     }
 }
 
-static void set_type_mappings() noexcept
+static void set_type_mappings()
 {
+    TraceEvent event("set_type_mappings", "apply_transforms");
+    std::uint64_t mapped = 0;
     for (auto&& type : Universe::get().types()) {
-        for (const auto& mapping : mappings) {
-            if (mapping.can_map(type)) {
-                type.set_mapping(mapping);
-            }
+        // A pattern may match the type it maps to
+        if (const auto* mapping = mappings.find(type.name()); mapping && mapping->to() != type.name()) {
+            type.set_mapping(*mapping);
+            ++mapped;
         }
     }
+    event.arg("mappings", mappings.size()).arg("mapped_types", mapped);
 }
 
 static void do_map(NonTypeSymbol& symbol)
@@ -657,6 +662,7 @@ static void do_map(NonTypeSymbol& symbol)
 
 static void do_map()
 {
+    TraceEvent event("do_map", "apply_transforms");
     auto& universe = Universe::get();
     for (auto& top_level : universe.top_level()) {
         do_map(top_level);
@@ -684,6 +690,8 @@ void apply_transforms()
     // Apply mappings
     set_type_mappings();
     do_map();
+
+    freeze_types();
 }
 
 } // namespace objcgen
@@ -276,6 +276,22 @@ public:
     // has been registered.
     [[nodiscard]] const NonTypeSymbol* global_non_type_symbol(std::string_view name) const;
 
+    /** The number of registered types.  The types registered later have greater indices. */
+    [[nodiscard]] std::size_t type_count() const noexcept
+    {
+        return type_order_.size();
+    }
+
+    /** The type registered `index`-th, in the order of `types()` */
+    [[nodiscard]] NamedTypeSymbol& type_at(std::size_t index) const
+    {
+        assert(index < type_order_.size());
+        const auto& el = type_order_[index];
+        auto* symbol = type(el.ns, el.name);
+        assert(symbol);
+        return *symbol;
+    }
+
     [[nodiscard]] auto types() const noexcept
     {
         using TypeOrder = decltype(type_order_);
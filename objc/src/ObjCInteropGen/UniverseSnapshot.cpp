@@ -0,0 +1,782 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "UniverseSnapshot.h"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+
+#include "FatalException.h"
+#include "Logging.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include "Universe.h"
+
+namespace objcgen {
+
+// The snapshot is the header, the string table, and an array of 32-bit words where the strings
+// are referenced by their indexes and the symbols by their positions, so nothing depends on
+// the addresses.  The words are:
+//
+//     key, included files, input files, type headers, type bodies, top-level functions
+//
+// The type headers create the symbols in the registration order.  A type can reference only
+// the types registered before it in its header (the target of a typedef, the underlying type
+// of an enum), so the bodies referencing any types come after all the headers.
+
+static constexpr char SNAPSHOT_MAGIC[8] = {'O', 'B', 'J', 'C', 'U', 'N', 'I', 'V'};
+
+// Increment when the format or the symbols produced by the scanner change
+static constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+
+// The words are written in the native byte order
+static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// Type references: 0 is no symbol, then the unregistered built-in symbols (pointer, func,
+// block, varray) and the registered types in the registration order.  A type parameter is
+// referenced by its owner with TYPE_PARAMETER_BIT set, followed by the parameter index.
+static constexpr std::uint32_t NO_SYMBOL = 0;
+static constexpr std::uint32_t UNREGISTERED_SYMBOL_COUNT = 4;
+static constexpr std::uint32_t TYPE_PARAMETER_BIT = 0x80000000;
+
+enum class SymbolClass : std::uint32_t { BuiltIn, TypeDeclaration, Enum, TypeAlias, Unexposed };
+
+// Bits of the type declaration flags word
+static constexpr std::uint32_t FLAG_CTYPE = 1;
+static constexpr std::uint32_t FLAG_POINTER_OR_FUNC = 2;
+
+struct SnapshotHeader {
+    char magic_[sizeof(SNAPSHOT_MAGIC)];
+    std::uint32_t byte_order_mark_;
+    std::uint32_t version_;
+    std::uint32_t string_count_;
+    std::uint32_t string_bytes_;
+    std::uint32_t word_count_;
+};
+
+[[nodiscard]] static std::size_t padded(std::size_t size) noexcept
+{
+    return (size + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t) * sizeof(std::uint32_t);
+}
+
+[[nodiscard]] static std::array<TypeLikeSymbol*, UNREGISTERED_SYMBOL_COUNT> unregistered_symbols()
+{
+    auto& universe = Universe::get();
+    return {&universe.pointer(), &universe.func(), &universe.block(), &universe.varray()};
+}
+
+/** The types registered by the universe itself, which exist before anything is parsed */
+[[nodiscard]] static bool is_built_in(const NamedTypeSymbol& type)
+{
+    auto& universe = Universe::get();
+    return type.is(NamedTypeSymbol::Kind::Primitive) || &type == &universe.clazz() || &type == &universe.id() ||
+        &type == &universe.sel();
+}
+
+[[nodiscard]] static std::uint64_t unexposed_size(const UnexposedTypeSymbol& symbol)
+{
+    const auto& type = symbol.underlying_type();
+    if (type.kind() == Type::Kind::VArray) {
+        const auto& element = type.varray_element_type().symbol().as<PrimitiveTypeSymbol>();
+        return type.varray_size() * static_cast<std::uint64_t>(element.size());
+    }
+    return static_cast<std::uint64_t>(type.symbol().as<PrimitiveTypeSymbol>().size());
+}
+
+class SnapshotWriter final {
+public:
+    SnapshotWriter()
+    {
+        std::uint32_t ref = NO_SYMBOL;
+        for (auto* symbol : unregistered_symbols()) {
+            type_refs_.try_emplace(symbol, ++ref);
+        }
+        for (auto& type : Universe::get().types()) {
+            type_refs_.try_emplace(&type, ++ref);
+            if (const auto* decl = dynamic_cast<const TypeDeclarationSymbol*>(&type)) {
+                for (std::uint32_t i = 0; i < decl->parameter_count(); ++i) {
+                    parameter_refs_.try_emplace(&decl->parameter(i), ref, i);
+                }
+            }
+        }
+        std::uint32_t index = 0;
+        for (const auto& input_file : inputs) {
+            input_indexes_.try_emplace(&input_file, index++);
+        }
+    }
+
+    void save(const std::string& key, const std::vector<std::string>& included_files,
+        std::filesystem::file_time_type parse_start);
+
+    void write(std::ostream& stream) const;
+
+private:
+    void word(std::uint32_t value)
+    {
+        words_.push_back(value);
+    }
+
+    void word64(std::uint64_t value)
+    {
+        word(static_cast<std::uint32_t>(value));
+        word(static_cast<std::uint32_t>(value >> 32));
+    }
+
+    void count(std::size_t value)
+    {
+        if (value >= TYPE_PARAMETER_BIT) {
+            fatal("Too many symbols for a universe snapshot");
+        }
+        word(static_cast<std::uint32_t>(value));
+    }
+
+    void string(const std::string& value)
+    {
+        auto [it, inserted] = string_indexes_.try_emplace(value, static_cast<std::uint32_t>(strings_.size()));
+        if (inserted) {
+            strings_.push_back(&it->first);
+        }
+        word(it->second);
+    }
+
+    void location(const FileLevelSymbol& symbol);
+
+    void type(const Type& type);
+
+    void parameters(const NonTypeSymbol& method);
+
+    void member(const NonTypeSymbol& member);
+
+    void type_header(const NamedTypeSymbol& type);
+
+    void type_body(const NamedTypeSymbol& type);
+
+    std::unordered_map<const TypeLikeSymbol*, std::uint32_t> type_refs_;
+    std::unordered_map<const TypeParameterSymbol*, std::pair<std::uint32_t, std::uint32_t>> parameter_refs_;
+    std::unordered_map<const InputFile*, std::uint32_t> input_indexes_;
+    // The keys are stable in the node-based map
+    std::unordered_map<std::string, std::uint32_t> string_indexes_;
+    std::vector<const std::string*> strings_;
+    std::vector<std::uint32_t> words_;
+};
+
+void SnapshotWriter::location(const FileLevelSymbol& symbol)
+{
+    const auto* input_file = symbol.defining_file();
+    if (!input_file) {
+        word(0);
+        return;
+    }
+    word(input_indexes_.at(input_file) + 1);
+    word(symbol.location().line_);
+    word(symbol.location().col_);
+}
+
+void SnapshotWriter::type(const Type& type)
+{
+    if (!type.has_symbol_assigned()) {
+        word(NO_SYMBOL);
+        return;
+    }
+    if (type.kind() == Type::Kind::VArray) {
+        word(type_refs_.at(&type.symbol()));
+        word64(type.varray_size());
+        this->type(type.varray_element_type());
+        return;
+    }
+    if (type.kind() == Type::Kind::TypeParam) {
+        auto it = parameter_refs_.find(&type.symbol().as<TypeParameterSymbol>());
+        if (it == parameter_refs_.end()) {
+            fatal("Cannot save type parameter `", type.name(), "` that belongs to no registered type");
+        }
+        word(it->second.first | TYPE_PARAMETER_BIT);
+        word(it->second.second);
+    } else {
+        auto it = type_refs_.find(&type.symbol());
+        if (it == type_refs_.end()) {
+            fatal("Cannot save unregistered type `", type.name(), '`');
+        }
+        word(it->second);
+    }
+    word(static_cast<std::uint32_t>(type.nullability()));
+    count(type.parameters().size());
+    for (const auto& parameter : type.parameters()) {
+        this->type(parameter);
+    }
+}
+
+void SnapshotWriter::parameters(const NonTypeSymbol& method)
+{
+    count(method.parameter_count());
+    for (const auto& parameter : method.parameters()) {
+        string(parameter.name());
+        type(parameter.type());
+        word(parameter.is_consumed());
+    }
+}
+
+void SnapshotWriter::member(const NonTypeSymbol& member)
+{
+    word(static_cast<std::uint32_t>(member.kind()));
+    word(member.modifiers());
+    // The constructor derives the Cangjie name from the selector again
+    string(member.selector());
+    if (member.is_property()) {
+        string(member.getter());
+        string(member.setter());
+    } else {
+        type(member.return_type());
+        parameters(member);
+    }
+}
+
+void SnapshotWriter::type_header(const NamedTypeSymbol& type)
+{
+    if (is_built_in(type)) {
+        word(static_cast<std::uint32_t>(SymbolClass::BuiltIn));
+        string(type.name());
+        return;
+    }
+    if (dynamic_cast<const TypeDeclarationSymbol*>(&type)) {
+        word(static_cast<std::uint32_t>(SymbolClass::TypeDeclaration));
+    } else if (dynamic_cast<const EnumDeclarationSymbol*>(&type)) {
+        word(static_cast<std::uint32_t>(SymbolClass::Enum));
+    } else if (dynamic_cast<const TypeAliasSymbol*>(&type)) {
+        word(static_cast<std::uint32_t>(SymbolClass::TypeAlias));
+    } else if (dynamic_cast<const UnexposedTypeSymbol*>(&type)) {
+        word(static_cast<std::uint32_t>(SymbolClass::Unexposed));
+    } else {
+        fatal("Cannot save type `", type.name(), "` in a universe snapshot");
+    }
+    word(static_cast<std::uint32_t>(type.kind()));
+    string(type.name());
+    location(type);
+    if (const auto* decl = dynamic_cast<const TypeDeclarationSymbol*>(&type)) {
+        count(decl->parameter_count());
+        for (const auto& parameter : decl->parameters()) {
+            string(parameter.name());
+        }
+    } else if (const auto* enum_decl = dynamic_cast<const EnumDeclarationSymbol*>(&type)) {
+        word(type_refs_.at(&enum_decl->underlying_type()));
+    } else if (const auto* alias = dynamic_cast<const TypeAliasSymbol*>(&type)) {
+        this->type(alias->target());
+    } else {
+        word64(unexposed_size(type.as<UnexposedTypeSymbol>()));
+    }
+}
+
+void SnapshotWriter::type_body(const NamedTypeSymbol& type)
+{
+    if (is_built_in(type)) {
+        return;
+    }
+    if (const auto* decl = dynamic_cast<const TypeDeclarationSymbol*>(&type)) {
+        count(decl->bases().size());
+        for (const auto& base : decl->bases()) {
+            word(type_refs_.at(&base));
+        }
+        count(decl->member_count());
+        for (const auto& member : decl->members()) {
+            this->member(member);
+        }
+        const TypeLikeSymbol& type_like = *decl;
+        word((decl->is_ctype() ? FLAG_CTYPE : 0) | (type_like.contains_pointer_or_func() ? FLAG_POINTER_OR_FUNC : 0));
+    } else if (const auto* enum_decl = dynamic_cast<const EnumDeclarationSymbol*>(&type)) {
+        std::size_t constant_count = 0;
+        enum_decl->for_each_constant([&constant_count](const auto&) { ++constant_count; });
+        count(constant_count);
+        enum_decl->for_each_constant([this](const EnumConstantSymbol& constant) {
+            string(constant.name());
+            word64(constant.value128_lo<std::uint64_t>());
+            word64(constant.value128_hi<std::uint64_t>());
+        });
+    }
+}
+
+void SnapshotWriter::save(const std::string& key, const std::vector<std::string>& included_files,
+    std::filesystem::file_time_type parse_start)
+{
+    string(key);
+
+    count(included_files.size());
+    for (const auto& file : included_files) {
+        std::error_code error;
+        auto time = std::filesystem::last_write_time(file, error);
+        string(std::filesystem::absolute(file).u8string());
+        word64(static_cast<std::uint64_t>((error || time >= parse_start ? parse_start : time).time_since_epoch().count()));
+    }
+
+    count(input_indexes_.size());
+    for (const auto& input_file : inputs) {
+        string(input_file.path().u8string());
+    }
+
+    auto& universe = Universe::get();
+    count(universe.types().size());
+    for (const auto& type : universe.types()) {
+        type_header(type);
+    }
+    for (const auto& type : universe.types()) {
+        type_body(type);
+    }
+
+    count(universe.top_level().size());
+    for (const auto& function : universe.top_level()) {
+        location(function);
+        word(function.modifiers());
+        string(function.name());
+        type(function.return_type());
+        parameters(function);
+    }
+}
+
+void SnapshotWriter::write(std::ostream& stream) const
+{
+    std::vector<std::uint32_t> string_ends;
+    string_ends.reserve(strings_.size());
+    std::size_t string_bytes = 0;
+    for (const auto* string : strings_) {
+        string_bytes += string->size();
+        string_ends.push_back(static_cast<std::uint32_t>(string_bytes));
+    }
+    if (string_bytes > UINT32_MAX || words_.size() > UINT32_MAX) {
+        fatal("The universe is too large for a snapshot");
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic_, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.byte_order_mark_ = BYTE_ORDER_MARK;
+    header.version_ = SNAPSHOT_VERSION;
+    header.string_count_ = static_cast<std::uint32_t>(strings_.size());
+    header.string_bytes_ = static_cast<std::uint32_t>(string_bytes);
+    header.word_count_ = static_cast<std::uint32_t>(words_.size());
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(string_ends.data()),
+        static_cast<std::streamsize>(string_ends.size() * sizeof(std::uint32_t)));
+    for (const auto* string : strings_) {
+        stream.write(string->data(), static_cast<std::streamsize>(string->size()));
+    }
+    static constexpr char padding[sizeof(std::uint32_t)] = {};
+    stream.write(padding, static_cast<std::streamsize>(padded(string_bytes) - string_bytes));
+    stream.write(reinterpret_cast<const char*>(words_.data()),
+        static_cast<std::streamsize>(words_.size() * sizeof(std::uint32_t)));
+}
+
+class SnapshotReader final {
+public:
+    SnapshotReader(const std::string& path, std::string_view data) : path_(path), data_(data)
+    {
+    }
+
+    /** Returns false if the data is not a snapshot of this version of the generator */
+    [[nodiscard]] bool read_header();
+
+    [[nodiscard]] std::string_view string()
+    {
+        auto index = word();
+        if (index >= strings_.size()) {
+            corrupted();
+        }
+        return strings_[index];
+    }
+
+    [[nodiscard]] std::uint32_t word()
+    {
+        if (position_ >= word_count_) {
+            corrupted();
+        }
+        std::uint32_t value;
+        std::memcpy(&value, words_ + position_++ * sizeof(std::uint32_t), sizeof(value));
+        return value;
+    }
+
+    [[nodiscard]] std::uint64_t word64()
+    {
+        auto low = word();
+        return low | static_cast<std::uint64_t>(word()) << 32;
+    }
+
+    /** The number of the items that follow, each taking at least one word */
+    [[nodiscard]] std::size_t count()
+    {
+        auto value = word();
+        if (value > word_count_ - position_) {
+            corrupted();
+        }
+        return value;
+    }
+
+    void read_universe();
+
+private:
+    [[noreturn]] void corrupted() const
+    {
+        fatal("Universe snapshot `", path_, "` is corrupted");
+    }
+
+    template <class Symbol> [[nodiscard]] Symbol& symbol(std::uint32_t ref)
+    {
+        auto* symbol = ref == NO_SYMBOL || ref > types_.size() ? nullptr : dynamic_cast<Symbol*>(types_[ref - 1]);
+        if (!symbol) {
+            corrupted();
+        }
+        return *symbol;
+    }
+
+    [[nodiscard]] std::optional<Location> location();
+
+    [[nodiscard]] Type type();
+
+    [[nodiscard]] std::vector<ParameterSymbol> parameters();
+
+    void member(std::vector<NonTypeSymbol>& members);
+
+    void type_header(std::size_t index, const std::vector<NamedTypeSymbol*>& built_ins);
+
+    void type_body(NamedTypeSymbol& type);
+
+    const std::string& path_;
+    // The mapped snapshot file; the strings are views into it
+    std::string_view data_;
+    std::vector<std::string_view> strings_;
+    const char* words_ = nullptr;
+    std::size_t word_count_ = 0;
+    std::size_t position_ = 0;
+    std::vector<std::filesystem::path> input_paths_;
+    std::vector<TypeLikeSymbol*> types_;
+};
+
+bool SnapshotReader::read_header()
+{
+    SnapshotHeader header;
+    if (data_.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data_.data(), sizeof(header));
+    if (std::memcmp(header.magic_, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header.byte_order_mark_ != BYTE_ORDER_MARK || header.version_ != SNAPSHOT_VERSION) {
+        return false;
+    }
+    const auto ends_offset = sizeof(header);
+    const auto chars_offset = ends_offset + std::size_t{header.string_count_} * sizeof(std::uint32_t);
+    const auto words_offset = chars_offset + padded(header.string_bytes_);
+    if (data_.size() != words_offset + std::size_t{header.word_count_} * sizeof(std::uint32_t)) {
+        corrupted();
+    }
+
+    strings_.reserve(header.string_count_);
+    std::uint32_t begin = 0;
+    for (std::uint32_t i = 0; i < header.string_count_; ++i) {
+        std::uint32_t end;
+        std::memcpy(&end, data_.data() + ends_offset + i * sizeof(std::uint32_t), sizeof(end));
+        if (end < begin || end > header.string_bytes_) {
+            corrupted();
+        }
+        strings_.emplace_back(data_.data() + chars_offset + begin, end - begin);
+        begin = end;
+    }
+    words_ = data_.data() + words_offset;
+    word_count_ = header.word_count_;
+    return true;
+}
+
+std::optional<Location> SnapshotReader::location()
+{
+    auto input = word();
+    if (input == 0) {
+        return std::nullopt;
+    }
+    if (input > input_paths_.size()) {
+        corrupted();
+    }
+    auto line = word();
+    auto col = word();
+    return Location{input_paths_[input - 1], {line, col}};
+}
+
+Type SnapshotReader::type()
+{
+    auto ref = word();
+    if (ref == NO_SYMBOL) {
+        return {};
+    }
+    auto& varray = Universe::get().varray();
+    if (ref <= types_.size() && types_[ref - 1] == &varray) {
+        auto size = word64();
+        return Type(type(), static_cast<std::size_t>(size));
+    }
+    TypeLikeSymbol* symbol;
+    if (ref & TYPE_PARAMETER_BIT) {
+        auto& owner = this->symbol<TypeDeclarationSymbol>(ref & ~TYPE_PARAMETER_BIT);
+        auto index = word();
+        if (index >= owner.parameter_count()) {
+            corrupted();
+        }
+        symbol = &owner.parameter(index);
+    } else {
+        symbol = &this->symbol<TypeLikeSymbol>(ref);
+    }
+    auto nullability = word();
+    if (nullability > static_cast<std::uint32_t>(Nullability::Nonnull)) {
+        corrupted();
+    }
+    std::vector<Type> parameters(count());
+    for (auto& parameter : parameters) {
+        parameter = type();
+    }
+    return Type(*symbol, std::move(parameters), static_cast<Nullability>(nullability));
+}
+
+std::vector<ParameterSymbol> SnapshotReader::parameters()
+{
+    std::vector<ParameterSymbol> result;
+    auto parameter_count = count();
+    result.reserve(parameter_count);
+    for (std::size_t i = 0; i < parameter_count; ++i) {
+        std::string name(string());
+        auto& parameter = result.emplace_back(std::move(name), type());
+        if (word() != 0) {
+            parameter.set_consumed();
+        }
+    }
+    return result;
+}
+
+void SnapshotReader::member(std::vector<NonTypeSymbol>& members)
+{
+    auto kind = word();
+    if (kind > static_cast<std::uint32_t>(NonTypeSymbol::Kind::Constructor)) {
+        corrupted();
+    }
+    auto modifiers = static_cast<Modifiers>(word());
+    std::string name(string());
+    if (static_cast<NonTypeSymbol::Kind>(kind) == NonTypeSymbol::Kind::Property) {
+        std::string getter(string());
+        std::string setter(string());
+        members.emplace_back(std::move(name), std::move(getter), std::move(setter), modifiers);
+        return;
+    }
+    auto return_type = type();
+    auto parameters = this->parameters();
+    members.emplace_back(
+        std::move(name), static_cast<NonTypeSymbol::Kind>(kind), std::move(return_type), std::move(parameters), modifiers);
+}
+
+void SnapshotReader::type_header(std::size_t index, const std::vector<NamedTypeSymbol*>& built_ins)
+{
+    auto symbol_class = static_cast<SymbolClass>(word());
+    if (symbol_class == SymbolClass::BuiltIn) {
+        auto name = string();
+        if (index >= built_ins.size() || built_ins[index]->name() != name) {
+            corrupted();
+        }
+        types_.push_back(built_ins[index]);
+        return;
+    }
+    if (index < built_ins.size()) {
+        corrupted();
+    }
+    auto kind = word();
+    if (kind > static_cast<std::uint32_t>(NamedTypeSymbol::Kind::TopLevel)) {
+        corrupted();
+    }
+    std::string name(string());
+    auto location = this->location();
+    NamedTypeSymbol* symbol;
+    switch (symbol_class) {
+        case SymbolClass::TypeDeclaration: {
+            auto* decl = new TypeDeclarationSymbol(static_cast<NamedTypeSymbol::Kind>(kind), std::move(name));
+            auto parameter_count = count();
+            for (std::size_t i = 0; i < parameter_count; ++i) {
+                decl->add_parameter(std::string(string()));
+            }
+            symbol = decl;
+            break;
+        }
+        case SymbolClass::Enum:
+            symbol = new EnumDeclarationSymbol(std::move(name), this->symbol<NamedTypeSymbol>(word()));
+            break;
+        case SymbolClass::TypeAlias:
+            symbol = new TypeAliasSymbol(std::move(name), type());
+            break;
+        case SymbolClass::Unexposed:
+            symbol = new UnexposedTypeSymbol(std::move(name), static_cast<std::size_t>(word64()));
+            break;
+        default:
+            corrupted();
+    }
+    if (symbol->kind() != static_cast<NamedTypeSymbol::Kind>(kind)) {
+        corrupted();
+    }
+    if (location) {
+        symbol->set_definition_location(*location);
+    }
+    Universe::get().register_type(*symbol);
+    types_.push_back(symbol);
+}
+
+void SnapshotReader::type_body(NamedTypeSymbol& type)
+{
+    if (auto* decl = dynamic_cast<TypeDeclarationSymbol*>(&type)) {
+        auto base_count = count();
+        for (std::size_t i = 0; i < base_count; ++i) {
+            decl->add_base(symbol<TypeDeclarationSymbol>(word()));
+        }
+        std::vector<NonTypeSymbol> members;
+        auto member_count = count();
+        members.reserve(member_count);
+        for (std::size_t i = 0; i < member_count; ++i) {
+            member(members);
+        }
+        auto flags = word();
+        decl->restore_members(std::move(members), flags & FLAG_CTYPE, flags & FLAG_POINTER_OR_FUNC);
+    } else if (auto* enum_decl = dynamic_cast<EnumDeclarationSymbol*>(&type)) {
+        auto constant_count = count();
+        for (std::size_t i = 0; i < constant_count; ++i) {
+            std::string name(string());
+            auto low = word64();
+            auto high = word64();
+            enum_decl->add_constant(std::move(name), {low, high});
+        }
+    }
+}
+
+void SnapshotReader::read_universe()
+{
+    auto& universe = Universe::get();
+    std::vector<NamedTypeSymbol*> built_ins;
+    for (auto& type : universe.types()) {
+        built_ins.push_back(&type);
+    }
+
+    auto input_count = count();
+    for (std::size_t i = 0; i < input_count; ++i) {
+        // Keep the order of the input files, as it is the order of the outputs
+        input_paths_.emplace_back(inputs.add_file(std::filesystem::u8path(string())).path());
+    }
+
+    for (auto* symbol : unregistered_symbols()) {
+        types_.push_back(symbol);
+    }
+    auto type_count = count();
+    types_.reserve(types_.size() + type_count);
+    for (std::size_t i = 0; i < type_count; ++i) {
+        type_header(i, built_ins);
+    }
+    for (std::size_t i = 0; i < type_count; ++i) {
+        auto& type = *static_cast<NamedTypeSymbol*>(types_[UNREGISTERED_SYMBOL_COUNT + i]);
+        if (i >= built_ins.size()) {
+            type_body(type);
+        }
+    }
+
+    auto function_count = count();
+    for (std::size_t i = 0; i < function_count; ++i) {
+        auto location = this->location();
+        auto modifiers = static_cast<Modifiers>(word());
+        std::string name(string());
+        auto return_type = type();
+        auto& function =
+            universe.register_top_level_function(std::move(name), std::move(return_type), parameters(), modifiers);
+        if (location) {
+            function.set_definition_location(*location);
+        }
+    }
+
+    if (position_ != word_count_) {
+        corrupted();
+    }
+}
+
+void save_universe(const std::string& path, const std::string& key, const std::vector<std::string>& included_files,
+    std::filesystem::file_time_type parse_start)
+{
+    TraceEvent event("save_universe", "snapshot");
+    event.arg("path", path);
+    SnapshotWriter writer;
+    writer.save(key, included_files, parse_start);
+
+    // Write to a temporary file first, so that an interrupted run leaves no truncated snapshot
+    const auto temporary_path = path + ".tmp";
+    {
+        std::ofstream stream(temporary_path, std::ios::binary);
+        writer.write(stream);
+        if (!stream) {
+            fatal("Cannot write universe snapshot `", temporary_path, '`');
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        fatal("Cannot write universe snapshot `", path, "`: ", error.message());
+    }
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Saved universe snapshot `" << path << '`' << std::endl;
+    }
+}
+
+bool load_universe(const std::string& path, const std::string& key)
+{
+    TraceEvent event("load_universe", "snapshot");
+    event.arg("path", path);
+    MappedFile file;
+    if (!file.map(path)) {
+        std::error_code error;
+        if (!std::filesystem::exists(path, error)) {
+            if (verbosity >= LogLevel::INFO) {
+                std::cerr << "No universe snapshot `" << path << '`' << std::endl;
+            }
+            return false;
+        }
+        fatal("Cannot read universe snapshot `", path, '`');
+    }
+    event.arg("bytes", file.data().size());
+
+    SnapshotReader reader(path, file.data());
+    if (!reader.read_header()) {
+        if (verbosity >= LogLevel::INFO) {
+            std::cerr << "Universe snapshot `" << path << "` is written by another version of the generator"
+                      << std::endl;
+        }
+        return false;
+    }
+    if (reader.string() != key) {
+        if (verbosity >= LogLevel::INFO) {
+            std::cerr << "Universe snapshot `" << path << "` is saved for other sources" << std::endl;
+        }
+        return false;
+    }
+    auto file_count = reader.count();
+    for (std::size_t i = 0; i < file_count; ++i) {
+        auto file = std::filesystem::u8path(reader.string());
+        auto time = reader.word64();
+        std::error_code error;
+        auto actual_time = std::filesystem::last_write_time(file, error);
+        if (error || static_cast<std::uint64_t>(actual_time.time_since_epoch().count()) != time) {
+            if (verbosity >= LogLevel::INFO) {
+                std::cerr << "Universe snapshot `" << path << "` is out of date: `" << file.u8string()
+                          << "` has changed" << std::endl;
+            }
+            return false;
+        }
+    }
+
+    assert(inputs.begin() == inputs.end());
+    reader.read_universe();
+    const auto& universe = Universe::get();
+    event.arg("types", universe.types().size()).arg("functions", universe.top_level().size());
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Loaded universe snapshot `" << path << '`' << std::endl;
+    }
+    return true;
+}
+
+} // namespace objcgen
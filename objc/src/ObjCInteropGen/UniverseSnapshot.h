@@ -0,0 +1,35 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef UNIVERSESNAPSHOT_H
+#define UNIVERSESNAPSHOT_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace objcgen {
+
+/**
+ * Write the universe and the input files right after parsing to `path`.  `key` identifies the
+ * parsed sources, and `included_files` are the files read while parsing them.  The files
+ * modified after `parse_start` are recorded as modified at `parse_start`, so that the snapshot
+ * is never loaded for them.
+ */
+void save_universe(const std::string& path, const std::string& key, const std::vector<std::string>& included_files,
+    std::filesystem::file_time_type parse_start);
+
+/**
+ * Fill the empty universe and input files from the snapshot written by `save_universe`.
+ * Returns false without changing them if there is no snapshot at `path`, or it was written for
+ * another key or by another version of the generator, or any of its included files has changed.
+ */
+[[nodiscard]] bool load_universe(const std::string& path, const std::string& key);
+
+} // namespace objcgen
+
+#endif // UNIVERSESNAPSHOT_H
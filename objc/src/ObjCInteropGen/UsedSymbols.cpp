@@ -0,0 +1,287 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "UsedSymbols.h"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "Config.h"
+#include "FatalException.h"
+#include "Logging.h"
+#include "Strings.h"
+
+namespace objcgen {
+
+using names_t = std::unordered_set<std::string>;
+
+[[nodiscard]] static const toml::Array* get_usage_array(const toml::Table& usage, const std::string& property_name)
+{
+    auto property_it = usage.find(property_name);
+    if (property_it == usage.end()) {
+        return nullptr;
+    }
+    const auto& property_any = property_it->second;
+    if (!property_any.is<toml::Array>()) {
+        fatal("`usage` property `", property_name, "` should be a TOML array");
+    }
+    const auto& array = property_any.as<toml::Array>();
+    std::size_t i = 0;
+    for (auto&& item_any : array) {
+        if (!item_any.is<std::string>() || item_any.as<std::string>().empty()) {
+            fatal("`usage` array `", property_name, "` item #", i, " is not a non-empty TOML string");
+        }
+        i++;
+    }
+    return &array;
+}
+
+[[nodiscard]] static std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        fatal("Cannot read `", path.u8string(), '`');
+    }
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+/** Read a file listing one name per line.  Empty lines and lines starting with `#` are ignored. */
+static void add_names_from_list(names_t& names, const std::filesystem::path& path)
+{
+    auto text = read_file(path);
+    std::string_view rest = text;
+    while (!rest.empty()) {
+        auto eol = rest.find('\n');
+        auto line = rest.substr(0, eol);
+        rest = eol == std::string_view::npos ? std::string_view() : rest.substr(eol + 1);
+
+        constexpr std::string_view WHITESPACE = " \t\r";
+        auto begin = line.find_first_not_of(WHITESPACE);
+        if (begin == std::string_view::npos || line[begin] == '#') {
+            continue;
+        }
+        auto end = line.find_last_not_of(WHITESPACE);
+        names.emplace(line.substr(begin, end - begin + 1));
+    }
+}
+
+/**
+ * The generator renames some types to avoid name clashes (see `transform_type` and
+ * `resolve_tagged_clashes`), so the Cangjie code may refer to `FooProtocol` or `BarStruct`
+ * instead of the original `Foo` or `Bar`.
+ */
+static void add_identifier(names_t& names, std::string_view identifier)
+{
+    names.emplace(identifier);
+    for (bool stripped = true; stripped;) {
+        stripped = false;
+        for (auto suffix : {"Protocol"sv, "Struct"sv, "Union"sv, "Enum"sv}) {
+            if (identifier.size() > suffix.size() && ends_with(identifier, suffix)) {
+                identifier.remove_suffix(suffix.size());
+                names.emplace(identifier);
+                stripped = true;
+            }
+        }
+    }
+}
+
+[[nodiscard]] static bool is_identifier_start(char ch) noexcept
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+[[nodiscard]] static bool is_identifier_char(char ch) noexcept
+{
+    return is_identifier_start(ch) || (ch >= '0' && ch <= '9');
+}
+
+static std::size_t scan_cangjie_code(names_t& names, std::string_view text, std::size_t i, bool interpolation);
+
+/** Collect the identifier at `i` unless it is a numeric literal like `0xFF`.  Returns its end. */
+static std::size_t scan_identifier(names_t& names, std::string_view text, std::size_t i)
+{
+    auto begin = i;
+    while (i < text.size() && is_identifier_char(text[i])) {
+        ++i;
+    }
+    if (is_identifier_start(text[begin])) {
+        add_identifier(names, text.substr(begin, i - begin));
+    }
+    return i;
+}
+
+/** Whether a string or rune literal, possibly raw, starts at `i` */
+[[nodiscard]] static bool is_string_literal_start(std::string_view text, std::size_t i) noexcept
+{
+    if (text[i] == '#') {
+        i = text.find_first_not_of('#', i);
+        if (i == std::string_view::npos) {
+            return false;
+        }
+    }
+    return text[i] == '"' || text[i] == '\'';
+}
+
+/**
+ * Skip the string or rune literal at `i`: `"..."`, `'...'`, their multi-line forms `"""..."""`
+ * and `'''...'''`, and the raw forms `#"..."#` with any number of `#`.  The identifiers in the
+ * literal are collected, including those of the interpolations `${...}`.  Returns the end of the
+ * literal.
+ */
+static std::size_t scan_string_literal(names_t& names, std::string_view text, std::size_t i)
+{
+    const auto size = text.size();
+    std::size_t hashes = 0;
+    while (i < size && text[i] == '#') {
+        ++hashes;
+        ++i;
+    }
+    assert(i < size && (text[i] == '"' || text[i] == '\''));
+    const auto quote = text[i];
+    const std::string triple_quote(3, quote);
+    const auto multi_line = text.compare(i, 3, triple_quote) == 0;
+    i += multi_line ? 3 : 1;
+    std::string end_delimiter(multi_line ? 3 : 1, quote);
+    end_delimiter.append(hashes, '#');
+    while (i < size) {
+        auto ch = text[i];
+        if (text.compare(i, end_delimiter.size(), end_delimiter) == 0) {
+            return i + end_delimiter.size();
+        }
+        if (hashes == 0 && ch == '\\') {
+            i += 2;
+        } else if (hashes == 0 && ch == '$' && i + 1 < size && text[i + 1] == '{') {
+            i = scan_cangjie_code(names, text, i + 2, true);
+        } else if (!multi_line && ch == '\n') {
+            // An unterminated single-line literal, do not let it swallow the next lines
+            return i;
+        } else if (is_identifier_char(ch)) {
+            i = scan_identifier(names, text, i);
+        } else {
+            ++i;
+        }
+    }
+    return size;
+}
+
+/**
+ * Collect the identifiers of Cangjie code from `i`, skipping comments.  In an `interpolation`,
+ * stop after the `}` closing it.  Returns the end of the scanned code.
+ */
+static std::size_t scan_cangjie_code(names_t& names, std::string_view text, std::size_t i, bool interpolation)
+{
+    const auto size = text.size();
+    std::size_t braces = 0;
+    while (i < size) {
+        auto ch = text[i];
+        auto next = i + 1 < size ? text[i + 1] : '\0';
+        if (ch == '/' && next == '/') {
+            i = text.find('\n', i);
+            if (i == std::string::npos) {
+                return size;
+            }
+        } else if (ch == '/' && next == '*') {
+            // Cangjie block comments can be nested
+            std::size_t depth = 0;
+            do {
+                if (text.compare(i, 2, "/*") == 0) {
+                    ++depth;
+                    i += 2;
+                } else if (text.compare(i, 2, "*/") == 0) {
+                    --depth;
+                    i += 2;
+                } else {
+                    ++i;
+                }
+            } while (depth != 0 && i < size);
+        } else if (is_string_literal_start(text, i)) {
+            i = scan_string_literal(names, text, i);
+        } else if (ch == '`') {
+            auto end = text.find('`', i + 1);
+            if (end == std::string::npos) {
+                return size;
+            }
+            add_identifier(names, text.substr(i + 1, end - i - 1));
+            i = end + 1;
+        } else if (is_identifier_char(ch)) {
+            i = scan_identifier(names, text, i);
+        } else {
+            if (interpolation) {
+                if (ch == '{') {
+                    ++braces;
+                } else if (ch == '}' && braces-- == 0) {
+                    return i + 1;
+                }
+            }
+            ++i;
+        }
+    }
+    return size;
+}
+
+/**
+ * Collect all identifiers of a Cangjie source file except those in comments.  Identifiers in
+ * string literals are collected too: that may only add unused entities, never lose used ones.
+ */
+static void add_names_from_cangjie_source(names_t& names, const std::filesystem::path& path)
+{
+    auto text = read_file(path);
+    scan_cangjie_code(names, text, 0, false);
+}
+
+static void add_names_from_cangjie_sources(names_t& names, const std::filesystem::path& path)
+{
+    if (std::filesystem::is_directory(path)) {
+        for (auto&& entry : std::filesystem::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".cj") {
+                add_names_from_cangjie_source(names, entry.path());
+            }
+        }
+    } else if (std::filesystem::exists(path)) {
+        add_names_from_cangjie_source(names, path);
+    } else {
+        fatal("`usage` array `cangjie-sources` item `", path.u8string(), "` doesn't exist");
+    }
+}
+
+std::optional<names_t> read_used_symbols()
+{
+    const auto* usage_any = Config::find("usage");
+    if (!usage_any) {
+        return std::nullopt;
+    }
+    if (!usage_any->is<toml::Table>()) {
+        fatal("`usage` should be a TOML table");
+    }
+    const auto& usage = usage_any->as<toml::Table>();
+
+    names_t names;
+    if (const auto* symbols = get_usage_array(usage, "symbols")) {
+        for (auto&& symbol : *symbols) {
+            names.insert(symbol.as<std::string>());
+        }
+    }
+    if (const auto* symbol_lists = get_usage_array(usage, "symbol-lists")) {
+        for (auto&& path : *symbol_lists) {
+            add_names_from_list(names, path.as<std::string>());
+        }
+    }
+    if (const auto* sources = get_usage_array(usage, "cangjie-sources")) {
+        for (auto&& path : *sources) {
+            add_names_from_cangjie_sources(names, path.as<std::string>());
+        }
+    }
+
+    if (verbosity >= LogLevel::INFO) {
+        std::cerr << "Usage-driven pruning: " << names.size() << " names are considered used" << std::endl;
+    }
+    return names;
+}
+
+} // namespace objcgen
@@ -0,0 +1,27 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef USEDSYMBOLS_H
+#define USEDSYMBOLS_H
+
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+namespace objcgen {
+
+/**
+ * Read the names of the entities used by the Cangjie code from the `usage` table of the
+ * configuration: the names listed explicitly, the names from the symbol list files and the
+ * identifiers found in the Cangjie sources.  Returns `std::nullopt` if `usage` is not configured,
+ * that is, if every entity matching the package filters is a root.
+ */
+[[nodiscard]] std::optional<std::unordered_set<std::string>> read_used_symbols();
+
+} // namespace objcgen
+
+#endif // USEDSYMBOLS_H
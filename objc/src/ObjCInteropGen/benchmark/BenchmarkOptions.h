@@ -0,0 +1,47 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef BENCHMARKOPTIONS_H
+#define BENCHMARKOPTIONS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "FatalException.h"
+#include "Strings.h"
+
+namespace objcgen {
+
+/** The value of the `--name=value` command line option, or nullopt if `arg` is another option */
+[[nodiscard]] inline std::optional<std::string_view> option_value(std::string_view arg, std::string_view name)
+{
+    if (starts_with(arg, name) && arg.size() > name.size() && arg[name.size()] == '=') {
+        return arg.substr(name.size() + 1);
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] inline std::uint64_t parse_number(std::string_view name, std::string_view value)
+{
+    std::size_t end = 0;
+    std::uint64_t result = 0;
+    try {
+        result = std::stoull(std::string(value), &end);
+    } catch (const std::exception&) {
+        end = 0;
+    }
+    if (value.empty() || end != value.size()) {
+        fatal("Invalid value of ", name, ": `", value, '`');
+    }
+    return result;
+}
+
+} // namespace objcgen
+
+#endif // BENCHMARKOPTIONS_H
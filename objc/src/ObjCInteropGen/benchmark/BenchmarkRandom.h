@@ -0,0 +1,51 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef BENCHMARKRANDOM_H
+#define BENCHMARKRANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace objcgen {
+
+/**
+ * splitmix64.  Unlike the standard distributions, it gives the same sequence on every platform,
+ * so the generated corpora and universes are reproducible.
+ */
+class BenchmarkRandom final {
+public:
+    explicit BenchmarkRandom(std::uint64_t seed) noexcept : state_(seed)
+    {
+    }
+
+    [[nodiscard]] std::uint64_t next() noexcept
+    {
+        auto z = (state_ += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    /** A number in [0, bound) */
+    [[nodiscard]] std::size_t below(std::size_t bound) noexcept
+    {
+        return bound == 0 ? 0 : static_cast<std::size_t>(next() % bound);
+    }
+
+    [[nodiscard]] bool percent(unsigned chance) noexcept
+    {
+        return below(100) < chance;
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+} // namespace objcgen
+
+#endif // BENCHMARKRANDOM_H
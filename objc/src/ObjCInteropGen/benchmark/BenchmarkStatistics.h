@@ -0,0 +1,67 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef BENCHMARKSTATISTICS_H
+#define BENCHMARKSTATISTICS_H
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "JsonWriter.h"
+
+namespace objcgen {
+
+/** Summary of the repeated measurements of a benchmark, in milliseconds */
+struct BenchmarkSummary {
+    double min_ = 0;
+    double median_ = 0;
+    double max_ = 0;
+};
+
+[[nodiscard]] inline BenchmarkSummary summarize(std::vector<double> samples)
+{
+    if (samples.empty()) {
+        return {};
+    }
+    std::sort(samples.begin(), samples.end());
+    auto middle = samples.size() / 2;
+    auto median = samples.size() % 2 == 0 ? (samples[middle - 1] + samples[middle]) / 2 : samples[middle];
+    return {samples.front(), median, samples.back()};
+}
+
+inline void print_summary_header(std::ostream& output, int name_width)
+{
+    output << std::left << std::setw(name_width) << "Benchmark" << std::right << std::setw(12) << "min, ms"
+           << std::setw(12) << "median, ms" << std::setw(12) << "max, ms" << std::endl;
+}
+
+inline void print_summary(std::ostream& output, int name_width, std::string_view name, const BenchmarkSummary& summary)
+{
+    auto flags = output.flags();
+    auto precision = output.precision(3);
+    output << std::fixed << std::left << std::setw(name_width) << name << std::right << std::setw(12) << summary.min_
+           << std::setw(12) << summary.median_ << std::setw(12) << summary.max_ << std::endl;
+    output.flags(flags);
+    output.precision(precision);
+}
+
+inline void write_summary(JsonWriter& json, std::string_view name, const BenchmarkSummary& summary)
+{
+    json.begin_object();
+    json.key("name").string(name);
+    json.key("min_ms").number(summary.min_);
+    json.key("median_ms").number(summary.median_);
+    json.key("max_ms").number(summary.max_);
+    json.end_object();
+}
+
+} // namespace objcgen
+
+#endif // BENCHMARKSTATISTICS_H
@@ -0,0 +1,410 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "CorpusGenerator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "BenchmarkRandom.h"
+#include "FatalException.h"
+
+namespace objcgen {
+
+constexpr const char* PRIMITIVE_TYPES[] = {"int", "double", "long long", "unsigned int", "float", "char"};
+
+static void write_file(const std::filesystem::path& path, const std::string& contents)
+{
+    std::ofstream output(path, std::ios::binary);
+    output << contents;
+    if (!output) {
+        fatal("Cannot write `", path.u8string(), '`');
+    }
+}
+
+[[nodiscard]] static std::string toml_string(const std::string& value)
+{
+    std::string result = "\"";
+    for (auto ch : value) {
+        if (ch == '"' || ch == '\\') {
+            result += '\\';
+        }
+        result += ch;
+    }
+    result += '"';
+    return result;
+}
+
+class CorpusGenerator final {
+public:
+    CorpusGenerator(const std::filesystem::path& directory, const CorpusParameters& parameters)
+        : directory_(directory),
+          parameters_(parameters),
+          random_(parameters.seed_),
+          headers_(std::max({parameters.headers_, parameters.packages_, std::size_t(1)})),
+          packages_(std::max(parameters.packages_, std::size_t(1)))
+    {
+    }
+
+    [[nodiscard]] Corpus generate(const std::vector<std::string>& clang_arguments);
+
+private:
+    [[nodiscard]] std::size_t package_of_header(std::size_t header) const noexcept
+    {
+        return header * packages_ / headers_;
+    }
+
+    [[nodiscard]] std::size_t header_of_class(std::size_t index) const noexcept
+    {
+        return index * headers_ / parameters_.classes_;
+    }
+
+    [[nodiscard]] std::string prefix(std::size_t header) const
+    {
+        return "Bench" + std::to_string(package_of_header(header)) + '_';
+    }
+
+    [[nodiscard]] std::string class_name(std::size_t index) const
+    {
+        return prefix(header_of_class(index)) + "Class" + std::to_string(index);
+    }
+
+    [[nodiscard]] static std::string protocol_name(std::size_t index)
+    {
+        return "BenchBaseProtocol" + std::to_string(index);
+    }
+
+    [[nodiscard]] std::string random_type(bool allow_objects);
+
+    void write_base_header(std::ostringstream& output);
+
+    void write_ownership_class(std::ostringstream& output, Corpus& corpus);
+
+    void write_c_declarations(std::ostringstream& output, std::size_t header);
+
+    void write_inline_function(std::ostringstream& output, const std::string& name);
+
+    void write_class(std::ostringstream& output, std::size_t index);
+
+    void write_category(std::ostringstream& output, std::size_t index, std::size_t class_index);
+
+    const std::filesystem::path& directory_;
+    const CorpusParameters& parameters_;
+    BenchmarkRandom random_;
+    const std::size_t headers_;
+    const std::size_t packages_;
+    /** Names of the C types declared in the already written headers */
+    std::vector<std::string> c_types_;
+    /** Classes referenced in the current header, to be forward declared with `@class` */
+    std::vector<std::string> forward_classes_;
+};
+
+std::string CorpusGenerator::random_type(bool allow_objects)
+{
+    auto choice = random_.below(allow_objects ? 10 : 6);
+    if (choice < 3 || c_types_.empty()) {
+        return PRIMITIVE_TYPES[random_.below(std::size(PRIMITIVE_TYPES))];
+    }
+    if (choice < 6) {
+        return c_types_[random_.below(c_types_.size())];
+    }
+    if (choice < 8 && parameters_.classes_ != 0) {
+        auto name = class_name(random_.below(parameters_.classes_));
+        forward_classes_.push_back(name);
+        return name + " *";
+    }
+    if (choice < 9 && parameters_.protocols_ != 0) {
+        return "id<" + protocol_name(random_.below(parameters_.protocols_)) + '>';
+    }
+    return "BenchBaseObject *";
+}
+
+void CorpusGenerator::write_base_header(std::ostringstream& output)
+{
+    output << "__attribute__((objc_root_class))\n"
+           << "@interface BenchBaseObject {\n"
+           << "    Class isa;\n"
+           << "}\n"
+           << "+ (instancetype)alloc;\n"
+           << "- (instancetype)init;\n"
+           << "- (int)benchHash;\n"
+           << "@end\n\n";
+
+    for (std::size_t i = 0; i < parameters_.protocols_; ++i) {
+        output << "@protocol " << protocol_name(i);
+        if (i != 0 && random_.percent(50)) {
+            output << " <" << protocol_name(random_.below(i)) << '>';
+        }
+        output << "\n- (int)protocol" << i << "Method:(int)value;\n";
+        if (random_.percent(30)) {
+            output << "@optional\n"
+                   << "@property (nonatomic, readonly) double protocol" << i << "Property;\n";
+        }
+        output << "@end\n\n";
+    }
+}
+
+/**
+ * Write a class with the ownership attributes, one method for each case.  It has no subclasses and
+ * no protocols, so the transforms copy none of its methods and `--stats` counts each attribute once.
+ */
+void CorpusGenerator::write_ownership_class(std::ostringstream& output, Corpus& corpus)
+{
+    output << "__attribute__((objc_root_class))\n"
+           << "@interface BenchBaseOwnership {\n"
+           << "    Class isa;\n"
+           << "}\n"
+           // +1 by the attribute, +0 by the family
+           << "- (BenchBaseObject *)makeObject __attribute__((ns_returns_retained));\n"
+           // +0 by the attribute, +1 by the family
+           << "- (BenchBaseObject *)copyObject __attribute__((ns_returns_not_retained));\n"
+           // +1 by the family only
+           << "- (BenchBaseObject *)newObject;\n"
+           << "- (const char *)innerBytes __attribute__((objc_returns_inner_pointer));\n"
+           << "- (void)takeObject:(BenchBaseObject *) __attribute__((ns_consumed)) object;\n"
+           << "@end\n\n";
+    corpus.ownership_attributed_results_ = 2;
+    corpus.inner_pointer_results_ = 1;
+    corpus.consumed_parameters_ = 1;
+}
+
+/** Write the C declarations of the header: the items of every kind are distributed over the headers round-robin */
+void CorpusGenerator::write_c_declarations(std::ostringstream& output, std::size_t header)
+{
+    const auto name_prefix = prefix(header);
+    for (auto i = header; i < parameters_.typedef_chains_; i += headers_) {
+        std::string previous = PRIMITIVE_TYPES[random_.below(std::size(PRIMITIVE_TYPES))];
+        for (std::size_t link = 0; link < parameters_.typedef_chain_length_; ++link) {
+            auto name = name_prefix + "Chain" + std::to_string(i) + '_' + std::to_string(link);
+            output << "typedef " << previous << ' ' << name << ";\n";
+            previous = std::move(name);
+        }
+        if (parameters_.typedef_chain_length_ != 0) {
+            c_types_.push_back(std::move(previous));
+        }
+    }
+    output << '\n';
+
+    for (auto i = header; i < parameters_.anonymous_enums_; i += headers_) {
+        auto name = name_prefix + "Enum" + std::to_string(i);
+        output << "typedef enum {\n";
+        auto values = 2 + random_.below(6);
+        for (std::size_t value = 0; value < values; ++value) {
+            output << "    " << name << "Value" << value << (value == 0 ? " = 1" : "") << ",\n";
+        }
+        output << "} " << name << ";\n\n";
+        c_types_.push_back(std::move(name));
+    }
+
+    for (auto i = header; i < parameters_.anonymous_structs_; i += headers_) {
+        auto name = name_prefix + "Struct" + std::to_string(i);
+        output << "typedef struct {\n";
+        auto fields = 1 + random_.below(4);
+        for (std::size_t field = 0; field < fields; ++field) {
+            output << "    " << random_type(false) << " field" << field << ";\n";
+        }
+        if (random_.percent(50)) {
+            output << "    struct {\n"
+                   << "        " << random_type(false) << " inner;\n"
+                   << "    } nested;\n";
+        }
+        output << "} " << name << ";\n\n";
+        c_types_.push_back(std::move(name));
+    }
+
+    for (auto i = header; i < parameters_.inline_functions_; i += headers_) {
+        write_inline_function(output, name_prefix + "Inline" + std::to_string(i));
+    }
+}
+
+void CorpusGenerator::write_inline_function(std::ostringstream& output, const std::string& name)
+{
+    output << "static inline int " << name << "(int count, double scale)\n"
+           << "{\n"
+           << "    int result = 0;\n"
+           << "    for (int i = 0; i < count; ++i) {\n"
+           << "        switch ((i * 7 + result) % 4) {\n";
+    for (int label = 0; label < 4; ++label) {
+        output << "            case " << label << ":\n";
+        auto statements = 1 + random_.below(4);
+        for (std::size_t statement = 0; statement < statements; ++statement) {
+            switch (random_.below(3)) {
+                case 0:
+                    output << "                result += (int)(scale * i) + " << random_.below(100) << ";\n";
+                    break;
+                case 1:
+                    output << "                result ^= result << " << 1 + random_.below(7) << ";\n";
+                    break;
+                default:
+                    output << "                if (result > " << random_.below(1000) << ") {\n"
+                           << "                    result = result / 3 - i;\n"
+                           << "                }\n";
+                    break;
+            }
+        }
+        output << "                break;\n";
+    }
+    output << "        }\n"
+           << "    }\n"
+           << "    return result;\n"
+           << "}\n\n";
+}
+
+void CorpusGenerator::write_class(std::ostringstream& output, std::size_t index)
+{
+    const auto name = class_name(index);
+    output << "@interface " << name << " : "
+           << (index % std::max(parameters_.depth_, std::size_t(1)) == 0 ? "BenchBaseObject" : class_name(index - 1));
+    if (parameters_.protocols_ != 0 && random_.percent(40)) {
+        output << " <" << protocol_name(random_.below(parameters_.protocols_)) << '>';
+    }
+    output << '\n';
+    for (std::size_t i = 0; i < parameters_.properties_; ++i) {
+        output << "@property (nonatomic" << (random_.percent(30) ? ", readonly" : "") << ") " << random_type(true)
+               << " class" << index << "Property" << i << ";\n";
+    }
+    // The same selectors in every class: overrides of the root class and superclass methods
+    output << "- (instancetype)initWithValue:(int)value;\n"
+           << "- (int)benchHash;\n";
+    for (std::size_t i = 0; i < parameters_.methods_; ++i) {
+        output << (random_.percent(10) ? '+' : '-') << " (" << (random_.percent(30) ? "void" : random_type(true))
+               << ")class" << index << "Method" << i;
+        auto arguments = random_.below(4);
+        for (std::size_t argument = 0; argument < arguments; ++argument) {
+            output << (argument == 0 ? ":(" : " with" + std::to_string(argument) + ":(") << random_type(true)
+                   << ")argument" << argument;
+        }
+        output << ";\n";
+    }
+    output << "@end\n\n";
+}
+
+void CorpusGenerator::write_category(std::ostringstream& output, std::size_t index, std::size_t class_index)
+{
+    output << "@interface " << class_name(class_index) << " (" << prefix(header_of_class(class_index)) << "Category"
+           << index << ")\n";
+    auto methods = 1 + random_.below(std::max(parameters_.methods_ / 2, std::size_t(1)));
+    for (std::size_t i = 0; i < methods; ++i) {
+        output << "- (" << random_type(true) << ")category" << index << "Method" << i << ":(" << random_type(true)
+               << ")argument;\n";
+    }
+    output << "@end\n\n";
+}
+
+static constexpr const char* FILE_COMMENT = "// Generated by objcgen_bench. Do not edit.\n";
+
+static void write_config(const std::filesystem::path& path, const std::filesystem::path& output_root,
+    const Corpus& corpus, const std::string& source_settings)
+{
+    std::ostringstream config;
+    config << "# Generated by objcgen_bench. Do not edit.\n\n"
+           << "[output-roots.default]\n"
+           << "path = " << toml_string(output_root.generic_u8string()) << "\n\n"
+           << "[sources.bench]\n"
+           << "paths = [" << toml_string(corpus.umbrella_header_.generic_u8string()) << "]\n"
+           << "arguments = [";
+    for (std::size_t i = 0; i < corpus.clang_arguments_.size(); ++i) {
+        config << (i == 0 ? "" : ", ") << toml_string(corpus.clang_arguments_[i]);
+    }
+    config << "]\n" << source_settings;
+    config << "\n[[packages]]\n"
+           << "package-name = \"bench.base\"\n"
+           << "filters = { include = \"BenchBase.+\" }\n";
+    for (std::size_t package = 0; package < corpus.packages_; ++package) {
+        config << "\n[[packages]]\n"
+               << "package-name = \"bench.p" << package << "\"\n"
+               << "filters = { include = \"Bench" << package << "_.+\" }\n";
+    }
+    write_file(path, config.str());
+}
+
+Corpus CorpusGenerator::generate(const std::vector<std::string>& clang_arguments)
+{
+    std::filesystem::create_directories(directory_);
+    Corpus corpus;
+    corpus.directory_ = directory_;
+    corpus.umbrella_header_ = directory_ / "Bench.h";
+    corpus.config_path_ = directory_ / "bench.toml";
+    corpus.output_root_ = directory_ / "out";
+    corpus.packages_ = packages_;
+    corpus.clang_arguments_ = clang_arguments;
+
+    std::ostringstream umbrella;
+    umbrella << FILE_COMMENT;
+
+    {
+        std::ostringstream output;
+        output << FILE_COMMENT << '\n';
+        write_base_header(output);
+        write_ownership_class(output, corpus);
+        auto path = directory_ / "BenchBase.h";
+        write_file(path, output.str());
+        corpus.headers_.push_back(path);
+        umbrella << "#import \"BenchBase.h\"\n";
+    }
+
+    // Categories are declared in the header of the class they extend
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> categories(headers_);
+    if (parameters_.classes_ != 0) {
+        for (std::size_t i = 0; i < parameters_.categories_; ++i) {
+            auto class_index = random_.below(parameters_.classes_);
+            categories[header_of_class(class_index)].emplace_back(i, class_index);
+        }
+    }
+
+    std::size_t next_class = 0;
+    for (std::size_t header = 0; header < headers_; ++header) {
+        // The headers rely on the umbrella header importing them in order (like private framework
+        // headers do), which keeps the include depth constant for any number of headers.
+        std::ostringstream declarations;
+        write_c_declarations(declarations, header);
+        forward_classes_.clear();
+        for (; next_class < parameters_.classes_ && header_of_class(next_class) == header; ++next_class) {
+            write_class(declarations, next_class);
+        }
+        for (auto [index, class_index] : categories[header]) {
+            write_category(declarations, index, class_index);
+        }
+
+        std::ostringstream output;
+        output << FILE_COMMENT << '\n';
+        std::sort(forward_classes_.begin(), forward_classes_.end());
+        forward_classes_.erase(std::unique(forward_classes_.begin(), forward_classes_.end()), forward_classes_.end());
+        for (const auto& forward_class : forward_classes_) {
+            output << "@class " << forward_class << ";\n";
+        }
+        output << '\n' << declarations.str();
+
+        auto file_name = "Bench" + std::to_string(header) + ".h";
+        auto path = directory_ / file_name;
+        write_file(path, output.str());
+        corpus.headers_.push_back(path);
+        umbrella << "#import \"" << file_name << "\"\n";
+    }
+    write_file(corpus.umbrella_header_, umbrella.str());
+
+    write_config(corpus.config_path_, corpus.output_root_, corpus, {});
+
+    return corpus;
+}
+
+Corpus generate_corpus(const std::filesystem::path& directory, const CorpusParameters& parameters,
+    const std::vector<std::string>& clang_arguments)
+{
+    return CorpusGenerator(directory, parameters).generate(clang_arguments);
+}
+
+CorpusConfig write_corpus_config(const Corpus& corpus, const std::string& name, const std::string& source_settings)
+{
+    CorpusConfig config;
+    config.path_ = corpus.directory_ / ("bench-" + name + ".toml");
+    config.output_root_ = corpus.directory_ / ("out-" + name);
+    write_config(config.path_, config.output_root_, corpus, source_settings);
+    return config;
+}
+
+} // namespace objcgen
@@ -0,0 +1,80 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace objcgen {
+
+/** The shape of a synthetic Objective-C corpus */
+struct CorpusParameters {
+    std::size_t classes_ = 1000;
+    /** The length of the superclass chains, including the class derived from the root class */
+    std::size_t depth_ = 8;
+    std::size_t protocols_ = 50;
+    std::size_t categories_ = 200;
+    std::size_t methods_ = 10;
+    std::size_t properties_ = 4;
+    std::size_t typedef_chains_ = 50;
+    std::size_t typedef_chain_length_ = 4;
+    std::size_t anonymous_structs_ = 50;
+    std::size_t anonymous_enums_ = 50;
+    /** `static inline` functions with bodies, like the helpers of the SDK headers */
+    std::size_t inline_functions_ = 200;
+    std::size_t headers_ = 20;
+    std::size_t packages_ = 10;
+    std::uint64_t seed_ = 1;
+};
+
+/** A configuration of the corpus and the root of its outputs */
+struct CorpusConfig {
+    std::filesystem::path path_;
+    std::filesystem::path output_root_;
+};
+
+struct Corpus {
+    std::filesystem::path directory_;
+    std::filesystem::path config_path_;
+    std::filesystem::path umbrella_header_;
+    std::filesystem::path output_root_;
+    std::vector<std::filesystem::path> headers_;
+    std::size_t packages_ = 0;
+    std::vector<std::string> clang_arguments_;
+    /** The ownership attributes declared in the corpus, as counted by `--stats` */
+    std::size_t ownership_attributed_results_ = 0;
+    std::size_t inner_pointer_results_ = 0;
+    std::size_t consumed_parameters_ = 0;
+};
+
+/**
+ * Write a synthetic corpus into `directory`: the `Bench*.h` headers, the `Bench.h` umbrella header
+ * importing them and the `bench.toml` configuration with a package per group of headers.
+ *
+ * The corpus depends on `parameters` only (the same seed gives the same files on every platform)
+ * and declares its own root class, so that it can be parsed without Foundation or GNUstep headers.
+ * `clang_arguments` are added to the `arguments` of the generated source entry.
+ */
+[[nodiscard]] Corpus generate_corpus(const std::filesystem::path& directory, const CorpusParameters& parameters,
+    const std::vector<std::string>& clang_arguments);
+
+/**
+ * Write `bench-<name>.toml` next to `bench.toml`.  It differs in the `out-<name>` output root and
+ * in `source_settings`, the lines added to the source entry, so its outputs can be compared with
+ * those of `bench.toml`.
+ */
+[[nodiscard]] CorpusConfig write_corpus_config(
+    const Corpus& corpus, const std::string& name, const std::string& source_settings = {});
+
+} // namespace objcgen
+
+#endif // CORPUSGENERATOR_H
@@ -0,0 +1,205 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "SyntheticUniverse.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <vector>
+
+#include "BenchmarkRandom.h"
+#include "FatalException.h"
+#include "Universe.h"
+
+namespace objcgen {
+
+void write_synthetic_config(const std::filesystem::path& path, const SyntheticUniverseParameters& parameters)
+{
+    auto output_root = (path.parent_path() / "out").generic_u8string();
+    std::ofstream output(path);
+    output << "[output-roots.default]\n"
+           << "path = \"" << output_root << "\"\n";
+    for (std::size_t package = 0; package < std::max(parameters.packages_, std::size_t(1)); ++package) {
+        output << "\n[[packages]]\n"
+               << "package-name = \"mb.p" << package << "\"\n"
+               << "filters = { include = \"Mb" << package << "_.+\" }\n";
+    }
+    output << "\n[[packages]]\n"
+           << "package-name = \"mb.wide\"\n"
+           << "filters = { include = [\"MbWide.+\", \"MbChain.+\"], filter-not = \".+Internal\" }\n";
+    if (!output) {
+        fatal("Cannot write `", path.u8string(), '`');
+    }
+}
+
+class SyntheticUniverseBuilder final {
+public:
+    explicit SyntheticUniverseBuilder(const SyntheticUniverseParameters& parameters)
+        : parameters_(parameters),
+          universe_(Universe::get()),
+          random_(parameters.seed_),
+          packages_(std::max(parameters.packages_, std::size_t(1)))
+    {
+    }
+
+    void build();
+
+private:
+    template <class T> T& add_type(T* symbol)
+    {
+        universe_.register_type(*symbol);
+        symbol->set_definition_location({"synthetic.h", {++line_, 1}});
+        return *symbol;
+    }
+
+    [[nodiscard]] Type random_type();
+
+    void add_method(TypeDeclarationSymbol& decl, std::string name, Type return_type, std::size_t parameters);
+
+    void add_property(TypeDeclarationSymbol& decl, const std::string& name, Type type, bool readonly);
+
+    void build_classes();
+
+    void build_wide_hierarchy();
+
+    const SyntheticUniverseParameters& parameters_;
+    Universe& universe_;
+    BenchmarkRandom random_;
+    const std::size_t packages_;
+    unsigned line_ = 0;
+    std::vector<TypeDeclarationSymbol*> classes_;
+    std::vector<TypeAliasSymbol*> aliases_;
+};
+
+Type SyntheticUniverseBuilder::random_type()
+{
+    auto choice = random_.below(10);
+    if (choice < 4 && !classes_.empty()) {
+        return Type(*classes_[random_.below(classes_.size())], Nullability::Nonnull);
+    }
+    if (choice < 7 && !aliases_.empty()) {
+        return Type(*aliases_[random_.below(aliases_.size())]);
+    }
+    if (choice < 8) {
+        return Type(universe_.pointer(), {Type(universe_.int32())});
+    }
+    return Type(random_.percent(50) ? universe_.int64() : universe_.float64());
+}
+
+void SyntheticUniverseBuilder::add_method(
+    TypeDeclarationSymbol& decl, std::string name, Type return_type, std::size_t parameters)
+{
+    std::vector<ParameterSymbol> parameter_symbols;
+    for (std::size_t i = 0; i < parameters; ++i) {
+        name += i == 0 ? ":" : "with" + std::to_string(i) + ':';
+        parameter_symbols.emplace_back("argument" + std::to_string(i), random_type());
+    }
+    decl.add_member_method(std::move(name), std::move(return_type), std::move(parameter_symbols), 0);
+}
+
+void SyntheticUniverseBuilder::add_property(
+    TypeDeclarationSymbol& decl, const std::string& name, Type type, bool readonly)
+{
+    // Like libclang does, declare the accessor methods along with the property
+    decl.add_member_method(name, type, {}, 0);
+    std::string setter;
+    if (!readonly) {
+        setter = "set" + name + ':';
+        setter[3] = static_cast<char>(std::toupper(static_cast<unsigned char>(setter[3])));
+        decl.add_member_method(setter, Type(universe_.unit()), {ParameterSymbol("value", type)}, 0);
+    }
+    decl.add_property(name, name, std::move(setter), readonly ? ModifierReadonly : 0);
+}
+
+void SyntheticUniverseBuilder::build_classes()
+{
+    // The typedef chains go first, so that the classes can reference them.  The chains end with
+    // primitive and pointer types only, so that their targets are always registered earlier.
+    for (std::size_t chain = 0; chain < parameters_.typedef_chains_; ++chain) {
+        auto target = chain % 2 == 0 ? Type(universe_.int32()) : Type(universe_.pointer(), {Type(universe_.uint8())});
+        for (std::size_t link = 0; link < parameters_.typedef_chain_length_; ++link) {
+            auto name = "MbChain" + std::to_string(chain) + '_' + std::to_string(link);
+            auto& alias = add_type(new TypeAliasSymbol(std::move(name), std::move(target)));
+            target = Type(alias);
+            if (link + 1 == parameters_.typedef_chain_length_) {
+                aliases_.push_back(&alias);
+            }
+        }
+    }
+
+    // The classes are registered first and filled afterwards, so that the members can reference
+    // any of them
+    for (std::size_t i = 0; i < parameters_.classes_; ++i) {
+        auto package = i * packages_ / parameters_.classes_;
+        auto name = "Mb" + std::to_string(package) + "_Class" + std::to_string(i);
+        auto& decl = add_type(new TypeDeclarationSymbol(NamedTypeSymbol::Kind::Interface, std::move(name)));
+        if (parameters_.depth_ != 0 && i % parameters_.depth_ != 0) {
+            decl.add_base(*classes_.back());
+        }
+        classes_.push_back(&decl);
+    }
+    for (std::size_t i = 0; i < classes_.size(); ++i) {
+        auto& decl = *classes_[i];
+        auto prefix = "class" + std::to_string(i);
+        for (std::size_t property = 0; property < parameters_.properties_; ++property) {
+            add_property(decl, prefix + "Property" + std::to_string(property), random_type(), random_.percent(30));
+        }
+        // The same selector in every class, which are overrides in the superclass chains
+        add_method(decl, "benchHash", Type(universe_.int64()), 0);
+        for (std::size_t method = 0; method < parameters_.methods_; ++method) {
+            add_method(decl, prefix + "Method" + std::to_string(method), random_type(), random_.below(4));
+        }
+    }
+}
+
+void SyntheticUniverseBuilder::build_wide_hierarchy()
+{
+    if (parameters_.wide_subclasses_ == 0) {
+        return;
+    }
+    auto& base = add_type(new TypeDeclarationSymbol(NamedTypeSymbol::Kind::Interface, "MbWideBase"));
+    for (std::size_t member = 0; member < parameters_.wide_members_; ++member) {
+        auto name = "wideMember" + std::to_string(member);
+        if (member % 4 == 3) {
+            add_property(base, name, Type(base, Nullability::Nullable), member % 8 == 3);
+        } else {
+            add_method(base, std::move(name), Type(base, Nullability::Nonnull), member % 3);
+        }
+    }
+    for (std::size_t i = 0; i < parameters_.wide_subclasses_; ++i) {
+        auto& derived = add_type(
+            new TypeDeclarationSymbol(NamedTypeSymbol::Kind::Interface, "MbWide" + std::to_string(i)));
+        derived.add_base(base);
+        // Override three of every four members of the base, changing the return type
+        // nullabilities, which transform_base_derived has to fix
+        for (std::size_t member = 0; member < parameters_.wide_members_; ++member) {
+            if (member % 4 == 1) {
+                continue;
+            }
+            auto name = "wideMember" + std::to_string(member);
+            if (member % 4 == 3) {
+                add_property(derived, name, Type(derived, Nullability::Nonnull), member % 8 == 3);
+            } else {
+                add_method(derived, std::move(name), Type(derived, Nullability::Nullable), member % 3);
+            }
+        }
+        add_method(derived, "wide" + std::to_string(i) + "Method", random_type(), 1);
+    }
+}
+
+void SyntheticUniverseBuilder::build()
+{
+    build_classes();
+    build_wide_hierarchy();
+}
+
+void build_synthetic_universe(const SyntheticUniverseParameters& parameters)
+{
+    SyntheticUniverseBuilder(parameters).build();
+}
+
+} // namespace objcgen
@@ -0,0 +1,50 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#pragma once
+#ifndef SYNTHETICUNIVERSE_H
+#define SYNTHETICUNIVERSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace objcgen {
+
+/** The shape of a synthetic in-memory universe */
+struct SyntheticUniverseParameters {
+    std::size_t classes_ = 5000;
+    /** The length of the superclass chains */
+    std::size_t depth_ = 8;
+    std::size_t methods_ = 8;
+    std::size_t properties_ = 2;
+    /** The number of direct subclasses of the `MbWideBase` class */
+    std::size_t wide_subclasses_ = 1000;
+    /** The number of methods and properties of the `MbWideBase` class */
+    std::size_t wide_members_ = 64;
+    std::size_t typedef_chains_ = 500;
+    std::size_t typedef_chain_length_ = 6;
+    std::size_t packages_ = 16;
+    std::uint64_t seed_ = 1;
+};
+
+/**
+ * Write the TOML configuration matching the universe built by `build_synthetic_universe`: a
+ * `mb.pN` package with a single regex filter per class group and the `mb.wide` package with a
+ * combined filter for the wide hierarchy and the typedef chains.
+ */
+void write_synthetic_config(const std::filesystem::path& path, const SyntheticUniverseParameters& parameters);
+
+/**
+ * Register the synthetic symbols in `Universe::get()`, as if they were parsed from a single
+ * input file.  The universe can be built only once per process.
+ */
+void build_synthetic_universe(const SyntheticUniverseParameters& parameters);
+
+} // namespace objcgen
+
+#endif // SYNTHETICUNIVERSE_H
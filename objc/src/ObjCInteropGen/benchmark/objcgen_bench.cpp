@@ -0,0 +1,489 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+// End-to-end benchmark: generates a synthetic corpus and runs ObjCInteropGen on it several times,
+// collecting the per-stage timings reported by `--stats-format=json`.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkOptions.h"
+#include "BenchmarkStatistics.h"
+#include "CorpusGenerator.h"
+#include "FatalException.h"
+#include "JsonWriter.h"
+#include "Strings.h"
+
+using namespace objcgen;
+
+struct SizeOption {
+    std::string_view name_;
+    std::size_t CorpusParameters::*field_;
+    const char* description_;
+};
+
+constexpr SizeOption SIZE_OPTIONS[] = {
+    {"--classes", &CorpusParameters::classes_, "number of classes"},
+    {"--depth", &CorpusParameters::depth_, "length of the superclass chains"},
+    {"--protocols", &CorpusParameters::protocols_, "number of protocols"},
+    {"--categories", &CorpusParameters::categories_, "number of categories"},
+    {"--methods", &CorpusParameters::methods_, "methods per class"},
+    {"--properties", &CorpusParameters::properties_, "properties per class"},
+    {"--typedef-chains", &CorpusParameters::typedef_chains_, "number of typedef chains"},
+    {"--typedef-chain-length", &CorpusParameters::typedef_chain_length_, "typedefs in a chain"},
+    {"--anonymous-structs", &CorpusParameters::anonymous_structs_, "number of typedef'ed anonymous structs"},
+    {"--anonymous-enums", &CorpusParameters::anonymous_enums_, "number of typedef'ed anonymous enums"},
+    {"--inline-functions", &CorpusParameters::inline_functions_, "number of static inline functions with bodies"},
+    {"--headers", &CorpusParameters::headers_, "number of headers"},
+    {"--packages", &CorpusParameters::packages_, "number of Cangjie packages"},
+};
+
+static void show_help()
+{
+    CorpusParameters defaults;
+    std::cout << "Usage: objcgen_bench --generator=ObjCInteropGen [options]\n"
+              << "    --generator=file\n"
+              << "        the ObjCInteropGen executable to benchmark\n"
+              << "    --corpus-dir=dir\n"
+              << "        directory for the generated corpus and outputs (objcgen_bench_corpus by default)\n"
+              << "    --repeat=N\n"
+              << "        number of ObjCInteropGen runs (5 by default)\n"
+              << "    --report=file.json\n"
+              << "        write the summary of the runs in JSON\n"
+              << "    --generate-only\n"
+              << "        generate the corpus and exit\n"
+              << "    --compare-skip-function-bodies\n"
+              << "        also run ObjCInteropGen with `skip-function-bodies`, check that the outputs are the same\n"
+              << "        and report the time saved\n"
+              << "    --baseline-generator=file\n"
+              << "        also run another ObjCInteropGen build (for example, of the commit before a change), check\n"
+              << "        that the outputs are the same and report the time difference\n"
+              << "    --check-universe-roundtrip\n"
+              << "        also save the universe snapshot with one run and load it with another, and check that\n"
+              << "        both write the same outputs as the runs without the snapshot\n"
+              << "    --clang-arg=argument\n"
+              << "        add a Clang argument to the generated configuration (can be repeated)\n"
+              << "    --seed=N\n"
+              << "        seed of the corpus generator (" << defaults.seed_ << " by default)\n";
+    for (const auto& option : SIZE_OPTIONS) {
+        std::cout << "    " << option.name_ << "=N\n"
+                  << "        " << option.description_ << " (" << defaults.*option.field_ << " by default)\n";
+    }
+}
+
+[[nodiscard]] static std::string shell_quote(const std::string& arg)
+{
+#ifdef _WIN32
+    return '"' + arg + '"';
+#else
+    std::string result = "'";
+    for (auto ch : arg) {
+        if (ch == '\'') {
+            result += "'\\''";
+        } else {
+            result += ch;
+        }
+    }
+    result += '\'';
+    return result;
+#endif
+}
+
+/** Stage timings of one ObjCInteropGen run, in the order of the stages */
+struct RunStats {
+    std::vector<std::pair<std::string, double>> stages_;
+    double peak_rss_ = 0;
+};
+
+/** Stage timings of all the runs with a configuration */
+struct Measurements {
+    std::vector<std::pair<std::string, std::vector<double>>> stages_;
+    std::vector<double> totals_;
+    double peak_rss_ = 0;
+
+    void add(const RunStats& stats, double total, std::size_t run)
+    {
+        for (std::size_t i = 0; i < stats.stages_.size(); ++i) {
+            auto& [name, wall_ms] = stats.stages_[i];
+            if (i == stages_.size()) {
+                stages_.emplace_back(name, std::vector<double>());
+            } else if (stages_[i].first != name) {
+                fatal("Stage #", i, " of run #", run, " is `", name, "`, expected `", stages_[i].first, '`');
+            }
+            stages_[i].second.push_back(wall_ms);
+        }
+        totals_.push_back(total);
+        peak_rss_ = std::max(peak_rss_, stats.peak_rss_);
+    }
+
+    [[nodiscard]] double stage_median(std::string_view name) const
+    {
+        for (const auto& [stage_name, samples] : stages_) {
+            if (stage_name == name) {
+                return summarize(samples).median_;
+            }
+        }
+        return 0;
+    }
+
+    void print(std::ostream& output) const
+    {
+        constexpr int name_width = 40;
+        print_summary_header(output, name_width);
+        for (const auto& [name, samples] : stages_) {
+            print_summary(output, name_width, name, summarize(samples));
+        }
+        print_summary(output, name_width, "Process", summarize(totals_));
+        output << "Peak RSS: " << static_cast<std::uint64_t>(peak_rss_) / 1024 << " KiB" << std::endl;
+    }
+
+    void write(JsonWriter& json) const
+    {
+        json.key("stages").begin_array();
+        for (const auto& [name, samples] : stages_) {
+            write_summary(json, name, summarize(samples));
+        }
+        json.end_array();
+        json.key("process");
+        write_summary(json, "Process", summarize(totals_));
+        json.key("peak_rss").number(static_cast<std::uint64_t>(peak_rss_));
+    }
+};
+
+/**
+ * Extract the stage timings from the `--stats-format=json` report.  The report is written by
+ * `JsonWriter` with one key per line, and the stage objects are the only ones with a `name` key.
+ */
+[[nodiscard]] static RunStats read_stats(const std::filesystem::path& path)
+{
+    std::ifstream input(path);
+    if (!input) {
+        fatal("Cannot read statistics file `", path.u8string(), '`');
+    }
+    static const std::regex name_regex(R"re(^\s*"name": "(.*)",?$)re");
+    static const std::regex wall_regex(R"re(^\s*"wall_ms": ([0-9.eE+-]+),?$)re");
+    static const std::regex rss_regex(R"re(^\s*"peak_rss": ([0-9]+),?$)re");
+    RunStats stats;
+    std::string line;
+    std::string stage_name;
+    std::smatch match;
+    while (std::getline(input, line)) {
+        if (std::regex_match(line, match, name_regex)) {
+            stage_name = match[1];
+        } else if (std::regex_match(line, match, wall_regex)) {
+            stats.stages_.emplace_back(stage_name, std::stod(match[1]));
+        } else if (std::regex_match(line, match, rss_regex)) {
+            stats.peak_rss_ = std::stod(match[1]);
+        }
+    }
+    return stats;
+}
+
+/**
+ * Check that the `--stats-format=json` report counts the ownership attributes the corpus declares,
+ * so that a scanner change losing them does not go unnoticed
+ */
+static void check_ownership_counts(const std::filesystem::path& path, const Corpus& corpus)
+{
+    std::ifstream input(path);
+    if (!input) {
+        fatal("Cannot read statistics file `", path.u8string(), '`');
+    }
+    static const std::regex count_regex(R"re(^\s*"(\w+)": ([0-9]+),?$)re");
+    const std::pair<std::string_view, std::size_t> expected[] = {
+        {"attributed_results", corpus.ownership_attributed_results_},
+        {"inner_pointer_results", corpus.inner_pointer_results_},
+        {"consumed_parameters", corpus.consumed_parameters_},
+    };
+    std::size_t found = 0;
+    std::string line;
+    std::smatch match;
+    while (std::getline(input, line)) {
+        if (!std::regex_match(line, match, count_regex)) {
+            continue;
+        }
+        for (const auto& [key, count] : expected) {
+            if (match[1].str() == key) {
+                if (std::stoull(match[2]) != count) {
+                    fatal("`", path.u8string(), "` reports ", match[2], " ", key, ", the corpus declares ", count);
+                }
+                ++found;
+            }
+        }
+    }
+    if (found != std::size(expected)) {
+        fatal("`", path.u8string(), "` has no ownership counts");
+    }
+}
+
+/**
+ * A run compared with the default one.  The runs alternate, so that both are equally affected by
+ * the changes of the machine load, and the outputs must be the same.
+ */
+struct Variant {
+    std::string title_;
+    std::string report_key_;
+    std::string generator_;
+    CorpusConfig config_;
+    Measurements measurements_;
+};
+
+/** Run ObjCInteropGen once with `config_path`, adding the timings of the run to `measurements` */
+static void run_generator(const std::string& generator, const std::filesystem::path& config_path,
+    const std::filesystem::path& stats_path, Measurements& measurements, std::size_t run)
+{
+    auto command = shell_quote(generator) + " --stats=" + shell_quote(stats_path.u8string()) +
+        " --stats-format=json " + shell_quote(config_path.u8string());
+    auto start = std::chrono::steady_clock::now();
+    auto status = std::system(command.c_str());
+    auto total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (status != 0) {
+        fatal("ObjCInteropGen failed (exit status ", status, "): ", command);
+    }
+    measurements.add(read_stats(stats_path), total, run);
+}
+
+[[nodiscard]] static bool same_file_contents(const std::filesystem::path& lhs, const std::filesystem::path& rhs)
+{
+    std::ifstream lhs_input(lhs, std::ios::binary);
+    std::ifstream rhs_input(rhs, std::ios::binary);
+    return lhs_input && rhs_input &&
+        std::equal(std::istreambuf_iterator<char>(lhs_input), std::istreambuf_iterator<char>(),
+            std::istreambuf_iterator<char>(rhs_input), std::istreambuf_iterator<char>());
+}
+
+/** Check that the output roots have the same files with the same contents */
+static void check_same_outputs(const std::filesystem::path& expected_root, const std::filesystem::path& actual_root)
+{
+    std::size_t files = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(expected_root)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        auto relative = std::filesystem::relative(entry.path(), expected_root);
+        if (!same_file_contents(entry.path(), actual_root / relative)) {
+            fatal("`", (actual_root / relative).u8string(), "` differs from `", entry.path().u8string(), '`');
+        }
+        ++files;
+    }
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(actual_root)) {
+        if (entry.is_regular_file()) {
+            --files;
+        }
+    }
+    if (files != 0) {
+        fatal("`", actual_root.u8string(), "` and `", expected_root.u8string(), "` have different files");
+    }
+}
+
+[[nodiscard]] static bool file_contains(const std::filesystem::path& path, std::string_view text)
+{
+    std::ifstream input(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return contents.find(text) != std::string::npos;
+}
+
+/**
+ * Run ObjCInteropGen with `--save-universe`, then with `--load-universe` of the saved snapshot,
+ * and check that both write the same outputs as the default run.  The loading run must really
+ * load the snapshot, so that a drift between the writer and the reader of the snapshot format
+ * fails the check rather than falling back to parsing.
+ */
+static void check_universe_roundtrip(const std::string& generator, const Corpus& corpus)
+{
+    const auto snapshot_path = corpus.directory_ / "universe.snapshot";
+    std::filesystem::remove(snapshot_path);
+    for (std::string_view option : {"save-universe", "load-universe"}) {
+        auto config = write_corpus_config(corpus, std::string(option));
+        std::filesystem::remove_all(config.output_root_);
+        auto trace_path = corpus.directory_ / (config.path_.stem().u8string() + "-trace.json");
+        auto command = shell_quote(generator) + " --" + std::string(option) + '=' +
+            shell_quote(snapshot_path.u8string()) + " --trace-out=" + shell_quote(trace_path.u8string()) + ' ' +
+            shell_quote(config.path_.u8string());
+        auto status = std::system(command.c_str());
+        if (status != 0) {
+            fatal("ObjCInteropGen failed (exit status ", status, "): ", command);
+        }
+        if (option == "load-universe" && !file_contains(trace_path, R"("loaded": "true")")) {
+            fatal("ObjCInteropGen has not loaded the universe snapshot `", snapshot_path.u8string(), "`: ", command);
+        }
+        check_same_outputs(corpus.output_root_, config.output_root_);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try {
+        CorpusParameters parameters;
+        std::optional<std::string> generator;
+        std::filesystem::path corpus_dir = "objcgen_bench_corpus";
+        std::optional<std::string> report_path;
+        std::size_t repeat = 5;
+        bool generate_only = false;
+        bool compare_skip_function_bodies = false;
+        bool check_universe = false;
+        std::optional<std::string> baseline_generator;
+        std::vector<std::string> clang_arguments;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                show_help();
+                return 0;
+            }
+            if (arg == "--generate-only") {
+                generate_only = true;
+                continue;
+            }
+            if (arg == "--compare-skip-function-bodies") {
+                compare_skip_function_bodies = true;
+                continue;
+            }
+            if (arg == "--check-universe-roundtrip") {
+                check_universe = true;
+                continue;
+            }
+            if (auto value = option_value(arg, "--generator")) {
+                generator = std::string(*value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--baseline-generator")) {
+                baseline_generator = std::string(*value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--corpus-dir")) {
+                corpus_dir = std::string(*value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--report")) {
+                report_path = std::string(*value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--repeat")) {
+                repeat = parse_number("--repeat", *value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--seed")) {
+                parameters.seed_ = parse_number("--seed", *value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--clang-arg")) {
+                clang_arguments.emplace_back(*value);
+                continue;
+            }
+            auto found = false;
+            for (const auto& option : SIZE_OPTIONS) {
+                if (auto value = option_value(arg, option.name_)) {
+                    parameters.*option.field_ = parse_number(option.name_, *value);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                std::cerr << "Unknown option `" << arg << "`\n";
+                show_help();
+                return 1;
+            }
+        }
+        if (!generate_only && !generator) {
+            show_help();
+            return 1;
+        }
+
+        auto corpus = generate_corpus(corpus_dir, parameters, clang_arguments);
+        std::cout << "Generated " << corpus.headers_.size() << " headers in `" << corpus_dir.u8string() << '`'
+                  << std::endl;
+        if (generate_only) {
+            return 0;
+        }
+
+        std::vector<Variant> variants;
+        if (compare_skip_function_bodies) {
+            variants.push_back({"skip-function-bodies", "skip_function_bodies", *generator,
+                write_corpus_config(corpus, "skip-function-bodies", "skip-function-bodies = true\n"), {}});
+        }
+        if (baseline_generator) {
+            variants.push_back({"the baseline generator", "baseline", *baseline_generator,
+                write_corpus_config(corpus, "baseline"), {}});
+        }
+
+        Measurements measurements;
+        for (std::size_t run = 0; run < repeat; ++run) {
+            auto stats_name = "stats-" + std::to_string(run) + ".json";
+            run_generator(*generator, corpus.config_path_, corpus_dir / stats_name, measurements, run);
+            for (auto& variant : variants) {
+                run_generator(variant.generator_, variant.config_.path_,
+                    corpus_dir / (variant.config_.path_.stem().u8string() + '-' + stats_name),
+                    variant.measurements_, run);
+            }
+        }
+        if (repeat != 0) {
+            check_ownership_counts(corpus_dir / "stats-0.json", corpus);
+        }
+        for (const auto& variant : variants) {
+            check_same_outputs(corpus.output_root_, variant.config_.output_root_);
+        }
+        if (check_universe && repeat != 0) {
+            check_universe_roundtrip(*generator, corpus);
+        }
+
+        measurements.print(std::cout);
+        for (const auto& variant : variants) {
+            std::cout << "\nWith " << variant.title_ << ":\n";
+            variant.measurements_.print(std::cout);
+            constexpr std::string_view parse_stage = "Parsing Objective-C sources";
+            auto parse_difference =
+                variant.measurements_.stage_median(parse_stage) - measurements.stage_median(parse_stage);
+            auto process_difference =
+                summarize(variant.measurements_.totals_).median_ - summarize(measurements.totals_).median_;
+            auto flags = std::cout.flags();
+            auto precision = std::cout.precision(3);
+            std::cout << std::fixed << std::showpos << "Difference (median, negative is faster): "
+                      << parse_difference << " ms of parsing, " << process_difference
+                      << " ms of the process; the outputs are the same" << std::endl;
+            std::cout.flags(flags);
+            std::cout.precision(precision);
+        }
+
+        if (report_path) {
+            std::ofstream output(*report_path);
+            JsonWriter json(output);
+            json.begin_object();
+            json.key("parameters").begin_object();
+            json.key("seed").number(parameters.seed_);
+            for (const auto& option : SIZE_OPTIONS) {
+                json.key(remove_prefix(option.name_, "--")).number(parameters.*option.field_);
+            }
+            json.end_object();
+            json.key("runs").number(repeat);
+            measurements.write(json);
+            for (const auto& variant : variants) {
+                json.key(variant.report_key_).begin_object();
+                variant.measurements_.write(json);
+                json.end_object();
+            }
+            json.end_object();
+            if (!output) {
+                fatal("Cannot write report file `", *report_path, '`');
+            }
+        }
+    } catch (const FatalException&) {
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,445 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+// Microbenchmarks of the generator internals on a synthetic in-memory universe, which needs no
+// libclang parse.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "BenchmarkOptions.h"
+#include "BenchmarkStatistics.h"
+#include "Config.h"
+#include "FatalException.h"
+#include "IndentingStringStream.h"
+#include "JsonWriter.h"
+#include "MarkPackage.h"
+#include "Package.h"
+#include "SyntheticUniverse.h"
+#include "Transform.h"
+#include "Universe.h"
+
+using namespace objcgen;
+
+struct SizeOption {
+    std::string_view name_;
+    std::size_t SyntheticUniverseParameters::*field_;
+    const char* description_;
+};
+
+constexpr SizeOption SIZE_OPTIONS[] = {
+    {"--classes", &SyntheticUniverseParameters::classes_, "number of classes"},
+    {"--depth", &SyntheticUniverseParameters::depth_, "length of the superclass chains"},
+    {"--methods", &SyntheticUniverseParameters::methods_, "methods per class"},
+    {"--properties", &SyntheticUniverseParameters::properties_, "properties per class"},
+    {"--wide-subclasses", &SyntheticUniverseParameters::wide_subclasses_, "direct subclasses of MbWideBase"},
+    {"--wide-members", &SyntheticUniverseParameters::wide_members_, "members of MbWideBase"},
+    {"--typedef-chains", &SyntheticUniverseParameters::typedef_chains_, "number of typedef chains"},
+    {"--typedef-chain-length", &SyntheticUniverseParameters::typedef_chain_length_, "typedefs in a chain"},
+    {"--packages", &SyntheticUniverseParameters::packages_, "number of Cangjie packages"},
+};
+
+static void show_help()
+{
+    SyntheticUniverseParameters defaults;
+    std::cout << "Usage: objcgen_microbench [options]\n"
+              << "    --repeat=N\n"
+              << "        number of samples of every benchmark (10 by default)\n"
+              << "    --filter=text\n"
+              << "        run only the benchmarks with names containing the text\n"
+              << "    --report=file.json\n"
+              << "        write the summary of the benchmarks in JSON\n"
+              << "    --seed=N\n"
+              << "        seed of the universe generator (" << defaults.seed_ << " by default)\n";
+    for (const auto& option : SIZE_OPTIONS) {
+        std::cout << "    " << option.name_ << "=N\n"
+                  << "        " << option.description_ << " (" << defaults.*option.field_ << " by default)\n";
+    }
+}
+
+/** Keeps the benchmarked computations from being optimized away */
+static volatile std::size_t sink;
+
+[[nodiscard]] static double elapsed_ms(std::chrono::steady_clock::time_point start) noexcept
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class MicroBenchmarks final {
+public:
+    MicroBenchmarks(std::size_t repeat, std::string filter) : repeat_(repeat), filter_(std::move(filter))
+    {
+        print_summary_header(std::cout, NAME_WIDTH);
+    }
+
+    /** Run a benchmark that does not change the universe `repeat` times in this process */
+    void run(std::string name, const std::function<std::size_t()>& func)
+    {
+        if (!selected(name)) {
+            return;
+        }
+        std::vector<double> samples;
+        for (std::size_t i = 0; i < repeat_; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            sink = func();
+            samples.push_back(elapsed_ms(start));
+        }
+        add(std::move(name), samples);
+    }
+
+    /**
+     * Run the stages that change the universe.  `func` returns the time of each stage in
+     * milliseconds.  On POSIX, every sample is run in a forked process, which starts with the
+     * same universe.  Otherwise, a single sample is run in this process, after all other
+     * benchmarks.
+     */
+    void run_stages(const std::vector<std::string>& names, const std::function<std::vector<double>()>& func);
+
+    void write(JsonWriter& json) const
+    {
+        json.begin_array();
+        for (const auto& [name, summary] : results_) {
+            write_summary(json, name, summary);
+        }
+        json.end_array();
+    }
+
+private:
+    static constexpr int NAME_WIDTH = 40;
+
+    [[nodiscard]] bool selected(std::string_view name) const noexcept
+    {
+        return name.find(filter_) != std::string_view::npos;
+    }
+
+    void add(std::string name, const std::vector<double>& samples)
+    {
+        results_.emplace_back(std::move(name), summarize(samples));
+        print_summary(std::cout, NAME_WIDTH, results_.back().first, results_.back().second);
+        std::cout.flush();
+    }
+
+    const std::size_t repeat_;
+    const std::string filter_;
+    std::vector<std::pair<std::string, BenchmarkSummary>> results_;
+};
+
+void MicroBenchmarks::run_stages(const std::vector<std::string>& names, const std::function<std::vector<double>()>& func)
+{
+    if (std::none_of(names.begin(), names.end(), [this](const auto& name) { return selected(name); })) {
+        return;
+    }
+    std::vector<std::vector<double>> samples(names.size());
+#ifdef _WIN32
+    auto times = func();
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        samples[i].push_back(times[i]);
+    }
+#else
+    for (std::size_t run = 0; run < repeat_; ++run) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            fatal("Cannot create a pipe: ", std::strerror(errno));
+        }
+        std::cout.flush();
+        std::cerr.flush();
+        auto pid = fork();
+        if (pid < 0) {
+            fatal("Cannot fork: ", std::strerror(errno));
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            auto status = 1;
+            try {
+                auto times = func();
+                auto size = static_cast<ssize_t>(times.size() * sizeof(double));
+                if (::write(fds[1], times.data(), static_cast<std::size_t>(size)) == size) {
+                    status = 0;
+                }
+            } catch (...) {
+            }
+            _exit(status);
+        }
+        close(fds[1]);
+        std::vector<double> times(names.size());
+        auto size = static_cast<ssize_t>(times.size() * sizeof(double));
+        auto received = ::read(fds[0], times.data(), static_cast<std::size_t>(size));
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (received != size || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fatal("Benchmark process for `", names.front(), "` has failed");
+        }
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            samples[i].push_back(times[i]);
+        }
+    }
+#endif
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (selected(names[i])) {
+            add(names[i], samples[i]);
+        }
+    }
+}
+
+[[nodiscard]] static std::size_t write_indenting_stream(std::size_t lines)
+{
+    IndentingStringStream output;
+    for (std::size_t i = 0; i < lines; ++i) {
+        switch (i % 16) {
+            case 0:
+                output << "public class Synthetic" << i << " {\n";
+                output.indent();
+                break;
+            case 7:
+                output.set_comment();
+                output << "Commented out: " << i << '\n';
+                output.reset_comment();
+                break;
+            case 15:
+                output.dedent();
+                output << "}\n";
+                break;
+            default:
+                output << "public func method" << i << "(argument: Int64): Int64\n";
+                break;
+        }
+    }
+    return output.str().size();
+}
+
+int main(int argc, char* argv[])
+{
+    try {
+        SyntheticUniverseParameters parameters;
+        std::size_t repeat = 10;
+        std::string filter;
+        std::optional<std::string> report_path;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                show_help();
+                return 0;
+            }
+            if (auto value = option_value(arg, "--repeat")) {
+                repeat = parse_number("--repeat", *value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--filter")) {
+                filter = std::string(*value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--report")) {
+                report_path = std::string(*value);
+                continue;
+            }
+            if (auto value = option_value(arg, "--seed")) {
+                parameters.seed_ = parse_number("--seed", *value);
+                continue;
+            }
+            auto found = false;
+            for (const auto& option : SIZE_OPTIONS) {
+                if (auto value = option_value(arg, option.name_)) {
+                    parameters.*option.field_ = parse_number(option.name_, *value);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                std::cerr << "Unknown option `" << arg << "`\n";
+                show_help();
+                return 1;
+            }
+        }
+
+        auto directory = std::filesystem::temp_directory_path() / "objcgen_microbench";
+        std::filesystem::create_directories(directory);
+        auto config_path = directory / "microbench.toml";
+        write_synthetic_config(config_path, parameters);
+        Config::parse_from_toml_file(config_path.u8string());
+        create_packages();
+        build_synthetic_universe(parameters);
+
+        auto& universe = Universe::get();
+        std::vector<std::string> names;
+        std::vector<std::string> missing_names;
+        std::vector<const TypeAliasSymbol*> aliases;
+        std::vector<const Type*> member_types;
+        for (const auto& type : universe.types()) {
+            names.push_back(type.name());
+            missing_names.push_back(type.name() + "Missing");
+            if (const auto* alias = dynamic_cast<const TypeAliasSymbol*>(&type)) {
+                aliases.push_back(alias);
+            } else if (const auto* decl = dynamic_cast<const TypeDeclarationSymbol*>(&type)) {
+                for (const auto& member : decl->members()) {
+                    if (member.is_property()) {
+                        continue;
+                    }
+                    member_types.push_back(&member.return_type());
+                    for (const auto& parameter : member.parameters()) {
+                        member_types.push_back(&parameter.type());
+                    }
+                }
+            }
+        }
+        std::cerr << "Synthetic universe: " << names.size() << " types, " << member_types.size() << " member types"
+                  << std::endl;
+
+        const auto* single_filter = packages.by_cangjie_name(std::string("mb.p0"))->filters();
+        const auto* combined_filter = packages.by_cangjie_name(std::string("mb.wide"))->filters();
+
+        MicroBenchmarks benchmarks(repeat, std::move(filter));
+        benchmarks.run("Universe::type(name)", [&] {
+            std::size_t found = 0;
+            for (const auto& name : names) {
+                found += universe.type(name) != nullptr;
+            }
+            return found;
+        });
+        benchmarks.run("Universe::type(kind, name)", [&] {
+            std::size_t found = 0;
+            for (const auto& name : names) {
+                found += universe.type(NamedTypeSymbol::Kind::Interface, name) != nullptr;
+            }
+            return found;
+        });
+        benchmarks.run("Universe::type(name), missing", [&] {
+            std::size_t found = 0;
+            for (const auto& name : missing_names) {
+                found += universe.type(name) != nullptr;
+            }
+            return found;
+        });
+        benchmarks.run("UniverseNamedTypeIterator pass", [&] {
+            std::size_t interfaces = 0;
+            for (const auto& type : universe.types()) {
+                interfaces += type.is(NamedTypeSymbol::Kind::Interface);
+            }
+            return interfaces;
+        });
+        benchmarks.run("RegexFilter::apply", [&] {
+            std::size_t matched = 0;
+            for (const auto& name : names) {
+                matched += single_filter->apply(name);
+            }
+            return matched;
+        });
+        benchmarks.run("Combined filter apply", [&] {
+            std::size_t matched = 0;
+            for (const auto& name : names) {
+                matched += combined_filter->apply(name);
+            }
+            return matched;
+        });
+        benchmarks.run("Package filters, first match", [&] {
+            std::size_t matched = 0;
+            for (const auto& name : names) {
+                for (const auto& package : packages) {
+                    if (package.filters()->apply(name)) {
+                        ++matched;
+                        break;
+                    }
+                }
+            }
+            return matched;
+        });
+        benchmarks.run("TypeAliasSymbol::canonical_type", [&] {
+            std::size_t primitives = 0;
+            for (const auto* alias : aliases) {
+                primitives += alias->canonical_type().kind() == Type::Kind::Named;
+            }
+            return primitives;
+        });
+        benchmarks.run("Type::canonical_type (members)", [&] {
+            std::size_t named = 0;
+            for (const auto* type : member_types) {
+                named += type->canonical_type().kind() == Type::Kind::Named;
+            }
+            return named;
+        });
+        benchmarks.run("same_types (members)", [&] {
+            std::size_t same = 0;
+            auto count = member_types.size();
+            for (std::size_t i = 0; i < count; ++i) {
+                same += same_types(*member_types[i], *member_types[(i * 7 + 1) % count]);
+            }
+            return same;
+        });
+        benchmarks.run("IndentingStringStream, 100000 lines", [] { return write_indenting_stream(100000); });
+
+        // A struct for every sample, as the fields are removed
+        constexpr std::size_t REMOVE_FIELDS = 4096;
+        std::vector<std::unique_ptr<TypeDeclarationSymbol>> wide_structs;
+        for (std::size_t i = 0; i < repeat; ++i) {
+            auto& wide_struct = *wide_structs.emplace_back(
+                std::make_unique<TypeDeclarationSymbol>(NamedTypeSymbol::Kind::Struct, "MbWideRemove"));
+            for (std::size_t field = 0; field < REMOVE_FIELDS; ++field) {
+                wide_struct.add_field("wideField" + std::to_string(field), Type(universe.int64()), 0);
+            }
+        }
+        benchmarks.run("member_remove, half of 4096 struct fields", [&wide_structs] {
+            auto wide_struct = std::move(wide_structs.back());
+            wide_structs.pop_back();
+            // From the end, so that the indices of the fields left to remove do not change
+            for (auto i = REMOVE_FIELDS / 2; i-- > 0;) {
+                wide_struct->member_remove(i * 2);
+            }
+            return wide_struct->member_count();
+        });
+
+        // symbol_references_to_packages and transform_base_derived are internal to these stages,
+        // which dominate them on the synthetic universe
+        benchmarks.run_stages({"mark_package", "apply_transforms"}, [] {
+            auto start = std::chrono::steady_clock::now();
+            if (!mark_package()) {
+                fatal("mark_package has failed");
+            }
+            auto mark_package_ms = elapsed_ms(start);
+            start = std::chrono::steady_clock::now();
+            apply_transforms();
+            return std::vector{mark_package_ms, elapsed_ms(start)};
+        });
+
+        if (report_path) {
+            std::ofstream output(*report_path);
+            JsonWriter json(output);
+            json.begin_object();
+            json.key("parameters").begin_object();
+            json.key("seed").number(parameters.seed_);
+            for (const auto& option : SIZE_OPTIONS) {
+                json.key(remove_prefix(option.name_, "--")).number(parameters.*option.field_);
+            }
+            json.end_object();
+            json.key("samples").number(repeat);
+            json.key("benchmarks");
+            benchmarks.write(json);
+            json.end_object();
+            if (!output) {
+                fatal("Cannot write report file `", *report_path, '`');
+            }
+        }
+    } catch (const FatalException&) {
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -4,20 +4,32 @@
 //
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
+#include <fstream>
 #include <optional>
+#include <unordered_set>
+#include <vector>
 
+#include "Batch.h"
 #include "CangjieWriter.h"
+#include "ClangSession.h"
+#include "Daemon.h"
 #include "Diagnostics.h"
 #include "FatalException.h"
 #include "Logging.h"
 #include "Mappings.h"
 #include "MarkPackage.h"
 #include "Mode.h"
+#include "MultiTarget.h"
 #include "Package.h"
+#include "PackageGraph.h"
 #include "SourceScannerConfig.h"
+#include "Stats.h"
 #include "Strings.h"
 #include "TomlParseError.h"
+#include "Trace.h"
 #include "Transform.h"
+#include "Universe.h"
+#include "UniverseSnapshot.h"
 
 // clang -fobjc-runtime=gnustep `gnustep-config --objc-flags` -Xclang -ast-dump -c M.m -o M.o -v > ast.txt
 
@@ -26,9 +38,35 @@ using namespace objcgen;
 static void show_help(const char* executable)
 {
     std::cout << "Usage: " << (executable ? std::filesystem::path(executable).filename().string() : "ObjCInteropGen")
-              << " [-v] config-file.toml\n";
+              << " [-v] [--manifest-out=file.json] [--trace-out=file.json] [--stats[=file]]\n"
+              << "    [--stats-format=text|json] [--save-universe=file] [--load-universe=file]\n"
+              << "    [--connect=socket] config-file.toml...\n"
+              << "   or: ObjCInteropGen [-v] --serve=socket\n";
     std::cout << "    -v\n";
     std::cout << "        increase logging verbosity level (can be applied multiple times)\n";
+    std::cout << "    --manifest-out=file.json\n";
+    std::cout << "        write the JSON manifest of the generated packages and their dependencies\n";
+    std::cout << "    --trace-out=file.json\n";
+    std::cout << "        write the timeline of the generator stages in the Chrome trace event format\n";
+    std::cout << "    --stats[=file]\n";
+    std::cout << "        print the time of the generator stages, the peak memory usage and the symbol counts\n";
+    std::cout << "        to the standard output or to the file\n";
+    std::cout << "    --stats-format=text|json\n";
+    std::cout << "        set the format of the --stats report (text by default); implies --stats\n";
+    std::cout << "    --save-universe=file\n";
+    std::cout << "        write the parsed sources to the file, to be loaded by --load-universe\n";
+    std::cout << "    --load-universe=file\n";
+    std::cout << "        load the parsed sources from the file instead of parsing them if it was saved for the\n";
+    std::cout << "        same sources and none of the files they read has changed since then\n";
+    std::cout << "    --serve=socket\n";
+    std::cout << "        keep the parsed sources in memory and run the requests sent with --connect to the Unix\n";
+    std::cout << "        socket, reparsing the sources only when the files they read change\n";
+    std::cout << "    --connect=socket\n";
+    std::cout << "        send the command line to the --serve process listening on the socket\n";
+    std::cout << "    config-file.toml...\n";
+    std::cout << "        with multiple configuration files, the sources shared by them are parsed once, and the\n";
+    std::cout << "        configuration file name is appended to the names of the manifest, trace and statistics\n";
+    std::cout << "        files (not supported on Windows)\n";
 }
 
 static std::optional<std::string_view> get_arg_value(const char* const argv[], int& arg_index, std::string_view name)
@@ -51,102 +89,478 @@ static std::optional<std::string_view> get_arg_value(const char* const argv[], i
     return std::nullopt;
 }
 
-int main(int argc, char* argv[])
+/** Run a stage of the generator, recording its trace event and timing statistics */
+template <class Func> static auto run_stage(const char* name, Func func)
 {
-    std::string_view stage = "Parsing command line options";
+    TraceEvent event(name);
+    StageTimer timer(name);
+    return func(event);
+}
 
+/** Print the error of the exception being handled and return the exit status */
+[[nodiscard]] static int report_current_exception(std::string_view stage)
+{
     try {
-        if (argc <= 1) {
+        throw;
+    } catch (const TomlParseError& e) {
+        std::cerr << e.path() << ": " << e.what() << std::endl;
+    } catch (const FatalException&) {
+        // FatalException is assumed to print the error message before throwing
+    } catch (const std::exception& e) {
+        std::cerr << stage << ":\n" << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << stage << ":\n"
+                  << "Unknown exception" << std::endl;
+    }
+    return 1;
+}
+
+/** `dir/name.ext` with the configuration file name appended: `dir/name-config.ext` */
+[[nodiscard]] static std::string per_config_path(const std::string& path, const std::string& config_path)
+{
+    std::filesystem::path result(path);
+    auto extension = result.extension();
+    result.replace_filename(result.stem().u8string() + '-' + std::filesystem::path(config_path).stem().u8string());
+    result += extension;
+    return result.u8string();
+}
+
+/**
+ * The configuration file whose name, without the directory and the extension, repeats the name of
+ * an earlier one.  `per_config_path` would give both of them the same output files.
+ */
+[[nodiscard]] static std::optional<std::string> find_duplicate_stem(const std::vector<std::string>& config_paths)
+{
+    std::unordered_set<std::string> stems;
+    for (const auto& config_path : config_paths) {
+        if (!stems.insert(std::filesystem::path(config_path).stem().u8string()).second) {
+            return config_path;
+        }
+    }
+    return std::nullopt;
+}
+
+/** The outputs requested on the command line besides the Cangjie sources */
+struct OutputOptions {
+    std::optional<std::string> manifest_path_;
+    // Empty if the statistics are printed to `std::cout`
+    std::optional<std::string> stats_path_;
+    StatsFormat stats_format_ = StatsFormat::TEXT;
+};
+
+/**
+ * Run the stages following the parsing for the current configuration.  Returns false if the
+ * errors have been reported by `mark_package`.
+ */
+[[nodiscard]] static bool generate(const OutputOptions& options, std::string_view& stage)
+{
+    stage = "Creating Cangjie packages";
+    run_stage("create_packages", [](TraceEvent& event) {
+        create_packages();
+        event.arg("packages", packages.size());
+    });
+    if (!run_stage("mark_package", [](TraceEvent&) { return mark_package(); })) {
+        return false;
+    }
+
+    stage = "Transforming sources";
+    run_stage("check_marked_symbols", [](TraceEvent&) { check_marked_symbols(); });
+    run_stage("initialize_mappings", [](TraceEvent&) { initialize_mappings(); });
+    run_stage("apply_transforms", [](TraceEvent&) { apply_transforms(); });
+
+    stage = "Writing Cangjie outputs";
+    run_stage("write_cangjie", [](TraceEvent&) {
+        if (current_target) {
+            write_target_output();
+        } else {
+            write_cangjie();
+        }
+    });
+
+    if (options.manifest_path_) {
+        stage = "Writing package manifest";
+        run_stage("write_package_manifest", [&](TraceEvent&) { write_package_manifest(*options.manifest_path_); });
+    }
+
+    if (options.stats_path_) {
+        if (options.stats_path_->empty()) {
+            print_stats(std::cout, options.stats_format_);
+        } else {
+            std::ofstream stats_output(*options.stats_path_);
+            print_stats(stats_output, options.stats_format_);
+            if (!stats_output) {
+                fatal("Cannot write statistics file `", *options.stats_path_, '`');
+            }
+        }
+    }
+    return true;
+}
+
+/** The options of the command line or of a `--serve` request */
+struct CommandLine {
+    std::vector<std::string> config_paths_;
+    OutputOptions options_;
+    std::optional<std::string> trace_path_;
+    std::optional<std::string> serve_path_;
+    std::optional<std::string> connect_path_;
+    std::optional<std::string> save_universe_path_;
+    std::optional<std::string> load_universe_path_;
+    /** The range of the `--connect` option in `argv`, which is not forwarded to the server */
+    std::pair<int, int> connect_args_;
+};
+
+/**
+ * Parse the options, setting `verbosity` and `mode` along the way.  `argv[argc]` must be null.
+ * Returns the exit status if the generator should not run.
+ */
+[[nodiscard]] static std::optional<int> parse_command_line(
+    int argc, const char* const argv[], CommandLine& command_line)
+{
+    if (argc <= 1) {
+        show_help(argv[0]);
+        return 1;
+    }
+    if (argc == 2) {
+        std::string_view arg = argv[1];
+        if (arg == "--help" || arg == "-?" || arg == "-h") {
             show_help(argv[0]);
-            return 1;
+            return 0;
+        }
+    }
+    std::size_t verbosityVal = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (starts_with(arg, "-v")) {
+            verbosityVal += arg.length() - 1;
+            verbosity = static_cast<LogLevel>(verbosityVal);
+            continue;
+        }
+
+        if (arg == "--generate-definitions") {
+            mode = Mode::GENERATE_DEFINITIONS;
+            continue;
         }
-        if (argc == 2) {
-            std::string_view arg = argv[1];
-            if (arg == "--help" || arg == "-?" || arg == "-h") {
-                show_help(argv[0]);
-                return 0;
+
+        auto mode_string = get_arg_value(argv, i, "--mode");
+        if (mode_string) {
+            if (mode_string == "normal") {
+                mode = Mode::NORMAL;
+            } else if (mode_string == "experimental") {
+                mode = Mode::EXPERIMENTAL;
+            } else if (mode_string == "generate-definitions") {
+                mode = Mode::GENERATE_DEFINITIONS;
+            } else {
+                std::cerr << "Unknown mode \"" << *mode_string << "\"\n";
+                return 1;
             }
+            continue;
         }
-        std::size_t verbosityVal = 0;
-        bool config_specified = false;
-        for (int i = 1; i < argc; i++) {
-            std::string_view arg = argv[i];
-            if (starts_with(arg, "-v")) {
-                verbosityVal += arg.length() - 1;
-                verbosity = static_cast<LogLevel>(verbosityVal);
-                continue;
+
+        auto manifest_out = get_arg_value(argv, i, "--manifest-out");
+        if (manifest_out) {
+            if (manifest_out->empty()) {
+                std::cerr << "No file specified for --manifest-out\n";
+                return 1;
             }
+            command_line.options_.manifest_path_ = std::string(*manifest_out);
+            continue;
+        }
 
-            if (arg == "--generate-definitions") {
-                mode = Mode::GENERATE_DEFINITIONS;
-                continue;
-            }
-
-            auto mode_string = get_arg_value(argv, i, "--mode");
-            if (mode_string) {
-                if (mode_string == "normal") {
-                    mode = Mode::NORMAL;
-                } else if (mode_string == "experimental") {
-                    mode = Mode::EXPERIMENTAL;
-                } else if (mode_string == "generate-definitions") {
-                    mode = Mode::GENERATE_DEFINITIONS;
-                } else {
-                    std::cerr << "Unknown mode \"" << *mode_string << "\"\n";
-                    return 1;
-                }
-                continue;
+        if (arg == "--stats") {
+            command_line.options_.stats_path_ = std::string();
+            continue;
+        }
+        if (starts_with(arg, "--stats=")) {
+            command_line.options_.stats_path_ = std::string(arg.substr(sizeof("--stats=") - 1));
+            continue;
+        }
+
+        auto stats_format_string = get_arg_value(argv, i, "--stats-format");
+        if (stats_format_string) {
+            if (stats_format_string == "text") {
+                command_line.options_.stats_format_ = StatsFormat::TEXT;
+            } else if (stats_format_string == "json") {
+                command_line.options_.stats_format_ = StatsFormat::JSON;
+            } else {
+                std::cerr << "Unknown statistics format \"" << *stats_format_string << "\"\n";
+                return 1;
+            }
+            if (!command_line.options_.stats_path_) {
+                command_line.options_.stats_path_ = std::string();
             }
+            continue;
+        }
 
-            if (ends_with(arg, ".toml")) {
-                if (config_specified) {
-                    std::cerr << "Multiple .toml files specified\n";
-                    return 1;
-                }
-                config_specified = true;
-                Config::parse_from_toml_file(std::string(arg));
-                continue;
+        auto first = i;
+        auto serve = get_arg_value(argv, i, "--serve");
+        if (serve) {
+            if (serve->empty()) {
+                std::cerr << "No socket specified for --serve\n";
+                return 1;
+            }
+            command_line.serve_path_ = std::string(*serve);
+            continue;
+        }
+
+        auto connect = get_arg_value(argv, i, "--connect");
+        if (connect) {
+            if (connect->empty()) {
+                std::cerr << "No socket specified for --connect\n";
+                return 1;
             }
+            command_line.connect_path_ = std::string(*connect);
+            command_line.connect_args_ = {first, i + 1};
+            continue;
+        }
 
-            show_help(argv[0]);
+        auto save_universe = get_arg_value(argv, i, "--save-universe");
+        if (save_universe) {
+            if (save_universe->empty()) {
+                std::cerr << "No file specified for --save-universe\n";
+                return 1;
+            }
+            command_line.save_universe_path_ = std::string(*save_universe);
+            continue;
+        }
+
+        auto load_universe = get_arg_value(argv, i, "--load-universe");
+        if (load_universe) {
+            if (load_universe->empty()) {
+                std::cerr << "No file specified for --load-universe\n";
+                return 1;
+            }
+            command_line.load_universe_path_ = std::string(*load_universe);
+            continue;
+        }
+
+        auto trace_out = get_arg_value(argv, i, "--trace-out");
+        if (trace_out) {
+            if (trace_out->empty()) {
+                std::cerr << "No file specified for --trace-out\n";
+                return 1;
+            }
+            command_line.trace_path_ = std::string(*trace_out);
+            continue;
+        }
+
+        if (ends_with(arg, ".toml")) {
+            command_line.config_paths_.emplace_back(arg);
+            continue;
+        }
+
+        show_help(argv[0]);
+        return 1;
+    }
+    return std::nullopt;
+}
+
+/** Run a `--serve` request in a process that has the sources of its configuration parsed */
+[[nodiscard]] static int run_request(const char* executable, const std::vector<std::string>& args)
+{
+    std::vector<const char*> argv{executable};
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+    argv.push_back(nullptr);
+
+    std::string_view stage = "Parsing command line options";
+    TraceSession trace_session;
+    try {
+        // The request options do not depend on the options of the server
+        verbosity = LogLevel::WARNING;
+        mode = Mode::NORMAL;
+        CommandLine command_line;
+        if (auto status = parse_command_line(static_cast<int>(args.size() + 1), argv.data(), command_line)) {
+            return *status;
+        }
+        if (command_line.config_paths_.size() != 1 || command_line.serve_path_ || command_line.connect_path_) {
+            std::cerr << "A request should have a single configuration file\n";
+            return 1;
+        }
+        if (command_line.save_universe_path_ || command_line.load_universe_path_) {
+            std::cerr << "The universe snapshots are not supported by --serve requests\n";
             return 1;
         }
+        if (command_line.trace_path_) {
+            trace_session.start(*command_line.trace_path_);
+        }
 
-        if (!config_specified) {
-            show_help(argv[0]);
+        const auto& config_path = command_line.config_paths_.front();
+        stage = "Reading configuration";
+        run_stage("Reading configuration", [&](TraceEvent& event) {
+            event.arg("path", config_path);
+            Config::parse_from_toml_file(config_path);
+        });
+        if (!read_targets().empty()) {
+            std::cerr << "Multiple targets are not supported by --serve requests\n";
             return 1;
         }
+        return generate(command_line.options_, stage) ? 0 : 1;
+    } catch (...) {
+        return report_current_exception(stage);
+    }
+}
 
-        stage = "Parsing Objective-C sources";
+/**
+ * Parse the sources of the configuration, or load them from `--load-universe` if it was saved
+ * for the same sources.  Returns true if the universe has been loaded.
+ */
+[[nodiscard]] static bool parse_or_load_sources(const CommandLine& command_line)
+{
+    if (!command_line.save_universe_path_ && !command_line.load_universe_path_) {
         parse_sources();
+        return false;
+    }
+    auto units = collect_sources();
+    // The relative paths in the Clang arguments are resolved against the current directory
+    auto key = std::filesystem::current_path().u8string() + sources_key(units);
+    if (command_line.load_universe_path_ && load_universe(*command_line.load_universe_path_, key)) {
+        return true;
+    }
+    auto parse_start = std::filesystem::file_time_type::clock::now();
+    auto session = ClangSession::create();
+    parse_sources(*session, units);
+    if (command_line.save_universe_path_) {
+        save_universe(*command_line.save_universe_path_, key, session->included_files(), parse_start);
+    }
+    return false;
+}
 
-        stage = "Creating Cangjie packages";
-        create_packages();
-        if (!mark_package()) {
+int main(int argc, char* argv[])
+{
+    std::string_view stage = "Parsing command line options";
+    TraceSession trace_session;
+
+    try {
+        CommandLine command_line;
+        if (auto status = parse_command_line(argc, argv, command_line)) {
+            return *status;
+        }
+        const auto& config_paths = command_line.config_paths_;
+        const auto& options = command_line.options_;
+        const auto& trace_path = command_line.trace_path_;
+
+        if (command_line.connect_path_) {
+            std::vector<std::string> args;
+            auto [connect_first, connect_end] = command_line.connect_args_;
+            for (int i = 1; i < argc; i++) {
+                if (i < connect_first || i >= connect_end) {
+                    args.emplace_back(argv[i]);
+                }
+            }
+            return connect_to_server(*command_line.connect_path_, args);
+        }
+        if (command_line.serve_path_) {
+            if (!config_paths.empty()) {
+                std::cerr << "No configuration files are expected with --serve\n";
+                return 1;
+            }
+            if (command_line.save_universe_path_ || command_line.load_universe_path_) {
+                std::cerr << "The universe snapshots are not supported with --serve\n";
+                return 1;
+            }
+            stage = "Serving requests";
+            return serve(*command_line.serve_path_,
+                [&argv](const std::vector<std::string>& args) { return run_request(argv[0], args); });
+        }
+
+        if (config_paths.empty()) {
+            show_help(argv[0]);
             return 1;
         }
+        if (trace_path) {
+            trace_session.start(*trace_path);
+        }
+
+        if (config_paths.size() > 1) {
+            if (command_line.save_universe_path_ || command_line.load_universe_path_) {
+                std::cerr << "The universe snapshots are not supported with multiple configuration files\n";
+                return 1;
+            }
+            if (trace_path || options.manifest_path_ || (options.stats_path_ && !options.stats_path_->empty())) {
+                if (auto duplicate = find_duplicate_stem(config_paths)) {
+                    std::cerr << "The configuration file `" << *duplicate
+                              << "` has the same name as another one, so their per-configuration outputs would "
+                                 "overwrite each other\n";
+                    return 1;
+                }
+            }
+            stage = "Processing configurations";
+            return run_batch(config_paths, [&](const std::string& config_path) {
+                // Every configuration gets its own outputs, with the events and the statistics
+                // of the shared parsing included
+                TraceSession config_trace_session;
+                std::string_view config_stage = "Creating Cangjie packages";
+                try {
+                    if (trace_path) {
+                        config_trace_session.start(per_config_path(*trace_path, config_path));
+                    }
+                    if (!read_targets().empty()) {
+                        fatal("Multiple targets are not supported with multiple configuration files");
+                    }
+                    auto config_options = options;
+                    if (config_options.manifest_path_) {
+                        config_options.manifest_path_ = per_config_path(*config_options.manifest_path_, config_path);
+                    }
+                    if (config_options.stats_path_ && !config_options.stats_path_->empty()) {
+                        config_options.stats_path_ = per_config_path(*config_options.stats_path_, config_path);
+                    }
+                    return generate(config_options, config_stage) ? 0 : 1;
+                } catch (...) {
+                    return report_current_exception(config_stage);
+                }
+            });
+        }
 
-        stage = "Transforming sources";
-        check_marked_symbols();
+        const auto& config_path = config_paths.front();
+        stage = "Reading configuration";
+        run_stage("Reading configuration", [&](TraceEvent& event) {
+            event.arg("path", config_path);
+            Config::parse_from_toml_file(config_path);
+        });
 
-        initialize_mappings();
+        if (auto targets = read_targets(); !targets.empty()) {
+            if (command_line.save_universe_path_ || command_line.load_universe_path_) {
+                std::cerr << "The universe snapshots are not supported with multiple targets\n";
+                return 1;
+            }
+            stage = "Generating for targets";
+            return run_targets(targets, [&] {
+                // Every target gets its own outputs besides the Cangjie sources
+                TraceSession target_trace_session;
+                std::string_view target_stage = "Parsing Objective-C sources";
+                try {
+                    const auto& target_name = current_target->name_;
+                    if (trace_path) {
+                        target_trace_session.start(per_config_path(*trace_path, target_name));
+                    }
+                    auto target_options = options;
+                    if (target_options.manifest_path_) {
+                        target_options.manifest_path_ = per_config_path(*target_options.manifest_path_, target_name);
+                    }
+                    if (target_options.stats_path_ && !target_options.stats_path_->empty()) {
+                        target_options.stats_path_ = per_config_path(*target_options.stats_path_, target_name);
+                    }
+                    run_stage("Parsing Objective-C sources", [](TraceEvent&) { parse_sources(); });
+                    return generate(target_options, target_stage) ? 0 : 1;
+                } catch (...) {
+                    return report_current_exception(target_stage);
+                }
+            });
+        }
 
-        apply_transforms();
+        stage = "Parsing Objective-C sources";
+        run_stage("Parsing Objective-C sources", [&command_line](TraceEvent& event) {
+            event.arg("loaded", parse_or_load_sources(command_line) ? "true" : "false");
+            const auto& universe = Universe::get();
+            event.arg("types", universe.types().size()).arg("functions", universe.top_level().size());
+        });
 
-        stage = "Writing Cangjie outputs";
-        write_cangjie();
-    } catch (const TomlParseError& e) {
-        std::cerr << e.path() << ": " << e.what() << std::endl;
-        return 1;
-    } catch (const FatalException&) {
-        // FatalException is assumed to print the error message before throwing
-        return 1;
-    } catch (const std::exception& e) {
-        std::cerr << stage << ":\n" << e.what() << std::endl;
-        return 1;
+        if (!generate(options, stage)) {
+            return 1;
+        }
     } catch (...) {
-        std::cerr << stage << ":\n"
-                  << "Unknown exception" << std::endl;
-        return 1;
+        return report_current_exception(stage);
     }
 
     return 0;